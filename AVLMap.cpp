@@ -0,0 +1,140 @@
+/**
+ * Models an ordered map on an AVL tree.
+ * @param <K> key type of the map
+ * @param <V> value type of the map
+ * @author William Duncan, Cody Carter
+ * @see AVLMap
+ * <pre>
+ * Date: 10/18/2023
+ * </pre>
+ */
+#ifndef AVLMAP_CPP
+#define AVLMAP_CPP
+
+#include "AVLMap.h"
+#include "AVLTree.cpp"
+
+using namespace std;
+
+template <typename K, typename V>
+AVLMap<K,V>::AVLMap() : AVLMap([](const K& a, const K& b) -> int{return a < b? -1 : (b < a? 1 : 0);})
+{
+}
+
+template <typename K, typename V>
+AVLMap<K,V>::AVLMap(std::function<int(const K&, const K&)> fn)
+   : tree([fn](const pair<K,V>& a, const pair<K,V>& b) -> int{return fn(a.first, b.first);}), keyCmp(fn)
+{
+}
+
+template <typename K, typename V>
+V& AVLMap<K,V>::operator[](const K& key)
+{
+   return *try_emplace(key).first;
+}
+
+template <typename K, typename V>
+template <typename... Args>
+pair<V*, bool> AVLMap<K,V>::try_emplace(const K& key, Args&&... args)
+{
+   typedef typename AVLTree<pair<K,V>>::Node Node;
+   bool inserted = false;
+   Node* node = tree.findOrInsert(
+      [&](const Node* node) { return keyCmp(key, node->data.first); },
+      [](Node*) {},
+      [&]()
+      {
+         inserted = true;
+         return tree.newNode(piecewise_construct, forward_as_tuple(key),
+                             forward_as_tuple(std::forward<Args>(args)...));
+      });
+   return pair<V*, bool>(&node->data.second, inserted);
+}
+
+template <typename K, typename V>
+template <typename M>
+bool AVLMap<K,V>::insert_or_assign(const K& key, M&& value)
+{
+   typedef typename AVLTree<pair<K,V>>::Node Node;
+   bool inserted = false;
+   tree.findOrInsert(
+      [&](const Node* node) { return keyCmp(key, node->data.first); },
+      [&](Node* node) { node->data.second = std::forward<M>(value); },
+      [&]()
+      {
+         inserted = true;
+         return tree.newNode(key, std::forward<M>(value));
+      });
+   return inserted;
+}
+
+template <typename K, typename V>
+typename AVLTree<pair<K,V>>::Node* AVLMap<K,V>::locate(const K& key) const
+{
+   typename AVLTree<pair<K,V>>::Node* tmp = tree.root;
+   while (tmp)
+   {
+      int diff = keyCmp(key, tmp->data.first);
+      if (diff == 0)
+         return tmp;
+      tmp = diff < 0 ? tmp->left : tmp->right;
+   }
+   return NULL;
+}
+
+template <typename K, typename V>
+V* AVLMap<K,V>::find(const K& key)
+{
+   typename AVLTree<pair<K,V>>::Node* node = locate(key);
+   return node == NULL ? NULL : &node->data.second;
+}
+
+template <typename K, typename V>
+const V* AVLMap<K,V>::find(const K& key) const
+{
+   typename AVLTree<pair<K,V>>::Node* node = locate(key);
+   return node == NULL ? NULL : &node->data.second;
+}
+
+template <typename K, typename V>
+bool AVLMap<K,V>::contains(const K& key) const
+{
+   return locate(key) != NULL;
+}
+
+template <typename K, typename V>
+bool AVLMap<K,V>::erase(const K& key)
+{
+   typedef typename AVLTree<pair<K,V>>::Node Node;
+   return tree.removeMatching([&](const Node* node) { return keyCmp(key, node->data.first); });
+}
+
+template <typename K, typename V>
+bool AVLMap<K,V>::isEmpty() const
+{
+   return tree.isEmpty();
+}
+
+template <typename K, typename V>
+int AVLMap<K,V>::size() const
+{
+   return tree.size();
+}
+
+template <typename K, typename V>
+int AVLMap<K,V>::height() const
+{
+   return tree.height();
+}
+
+template <typename K, typename V>
+void AVLMap<K,V>::traverse(FuncType func)
+{
+   tree.traverse([&](const pair<K,V>& entry)
+      {
+         func(entry.first, const_cast<V&>(entry.second));
+      });
+}
+
+//AVLMAP_CPP
+#endif
@@ -0,0 +1,143 @@
+/**
+ * Models an ordered map on an AVL tree
+ * @author William Duncan, Cody Carter
+ * <pre>
+ * File: AVLMap.h
+ * Date: 10/18/2023
+ * </pre>
+ */
+
+#include <utility>
+#include <tuple>
+#include <functional>
+#include "AVLTree.h"
+
+#ifndef AVLMAP_H
+#define AVLMAP_H
+
+using namespace std;
+
+/**
+ * Describes operations on an ordered map whose entries are kept in an
+ * AVL tree. Each key-value pair is stored inline in a tree node, lookups
+ * take only a key, and every operation makes exactly one descent.
+ * @param <K> the key type
+ * @param <V> the value type
+ * @see AVLTree
+ */
+template <typename K, typename V>
+class AVLMap
+{
+private:
+   typedef std::function<void(const K&, V&)> FuncType;
+   /**
+    * the tree holding the entries of this map
+    */
+   AVLTree<pair<K,V>> tree;
+   /**
+    * A trichotomous integer-value comparator of keys
+    */
+   std::function<int(const K&, const K&)> keyCmp;
+
+   /**
+    * Gives the node holding the specified key
+    * @param key the search key
+    * @return the node holding the key or null if there is none
+    */
+   typename AVLTree<pair<K,V>>::Node* locate(const K& key) const;
+public:
+   /**
+    * Constructs an empty map ordered by the < operator on keys
+    */
+   AVLMap();
+
+   /**
+    * Constructs an empty map ordered by the specified comparator
+    * @param fn - an integer-value binary comparator function on keys
+    */
+   AVLMap(std::function<int(const K&, const K&)> fn);
+
+   /**
+    * Gives the value mapped to the specified key, inserting a
+    * default-constructed value when the key is not in this map
+    * @param key the search key
+    * @return a reference to the value mapped to the key
+    */
+   V& operator[](const K& key);
+
+   /**
+    * Inserts a value built from the given arguments unless the key is
+    * already in this map, in which case the map is left unchanged
+    * @param key the key of the entry
+    * @param args the arguments of the value's constructor
+    * @return a pointer to the value mapped to the key and whether the
+    * entry was inserted
+    */
+   template <typename... Args>
+   pair<V*, bool> try_emplace(const K& key, Args&&... args);
+
+   /**
+    * Maps the specified key to the specified value, replacing any value
+    * the key is already mapped to
+    * @param key the key of the entry
+    * @param value the new value
+    * @return true if the entry was inserted; false if it was assigned
+    */
+   template <typename M>
+   bool insert_or_assign(const K& key, M&& value);
+
+   /**
+    * Gives the value mapped to the specified key
+    * @param key the search key
+    * @return a pointer to the value or null if the key is not in this map
+    */
+   V* find(const K& key);
+
+   /**
+    * Gives the value mapped to the specified key
+    * @param key the search key
+    * @return a pointer to the value or null if the key is not in this map
+    */
+   const V* find(const K& key) const;
+
+   /**
+    * Determines whether the specified key is in this map
+    * @param key the search key
+    * @return true if the key is mapped to a value; otherwise, false
+    */
+   bool contains(const K& key) const;
+
+   /**
+    * Removes the entry with the specified key
+    * @param key the search key
+    * @return true if an entry was removed; otherwise, false
+    */
+   bool erase(const K& key);
+
+   /**
+    * Determines whether this map is empty
+    * @return true if this map has no entries; otherwise, false
+    */
+   bool isEmpty() const;
+
+   /**
+    * Gives the number of entries in this map
+    * @return the size of this map
+    */
+   int size() const;
+
+   /**
+    * Gives the height of the tree holding the entries of this map
+    * @return the height of the tree
+    */
+   int height() const;
+
+   /**
+    * Applies the specified function to each entry in key order
+    * @param func the function to apply to the key and value of each entry
+    */
+   void traverse(FuncType func);
+};
+
+//AVLMAP_H
+#endif
@@ -0,0 +1,63 @@
+/**
+ * Models a background reclaimer of detached node graphs.
+ * @author William Duncan, Cody Carter
+ * @see AVLReclaimer
+ * <pre>
+ * Date: 10/18/2023
+ * </pre>
+ */
+#ifndef AVLRECLAIMER_CPP
+#define AVLRECLAIMER_CPP
+
+#include "AVLReclaimer.h"
+
+using namespace std;
+
+inline AVLReclaimer::~AVLReclaimer()
+{
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      stopping = true;
+   }
+   ready.notify_one();
+   worker.join();
+}
+
+inline AVLReclaimer& AVLReclaimer::instance()
+{
+   static AVLReclaimer reclaimer;
+   return reclaimer;
+}
+
+inline void AVLReclaimer::submit(std::function<void()> job)
+{
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      jobs.push_back(std::move(job));
+   }
+   ready.notify_one();
+}
+
+/* Private functions */
+
+inline AVLReclaimer::AVLReclaimer() : stopping(false)
+{
+   worker = std::thread([this]()
+      {
+         std::unique_lock<std::mutex> guard(lock);
+         while (true)
+         {
+            ready.wait(guard, [this]() { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+               return;
+            std::function<void()> job = std::move(jobs.front());
+            jobs.pop_front();
+            guard.unlock();
+            job();
+            guard.lock();
+         }
+      });
+}
+
+//AVLRECLAIMER_CPP
+#endif
@@ -0,0 +1,74 @@
+/**
+ * Models a background reclaimer of detached node graphs
+ * @author William Duncan, Cody Carter
+ * <pre>
+ * File: AVLReclaimer.h
+ * Date: 10/18/2023
+ * </pre>
+ */
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#ifndef AVLRECLAIMER_H
+#define AVLRECLAIMER_H
+
+using namespace std;
+
+/**
+ * Frees detached node graphs on a background thread so that the thread
+ * that drops a large tree is not stalled. Pending work is finished
+ * before the program exits.
+ */
+class AVLReclaimer
+{
+private:
+   /**
+    * the pending reclamation jobs
+    */
+   deque<std::function<void()>> jobs;
+   /**
+    * guards the job queue
+    */
+   std::mutex lock;
+   /**
+    * signals the worker that a job is pending or that it should stop
+    */
+   std::condition_variable ready;
+   /**
+    * whether the worker should stop once the queue is drained
+    */
+   bool stopping;
+   /**
+    * the thread that runs the jobs
+    */
+   std::thread worker;
+
+   /**
+    * Starts the worker thread
+    */
+   AVLReclaimer();
+public:
+   /**
+    * destructor - finishes the pending jobs and stops the worker
+    */
+   ~AVLReclaimer();
+
+   /**
+    * Gives the process-wide reclaimer
+    * @return the reclaimer shared by all trees
+    */
+   static AVLReclaimer& instance();
+
+   /**
+    * Queues a job to be run on the reclaimer thread
+    * @param job the function that frees the memory
+    */
+   void submit(std::function<void()> job);
+};
+
+//AVLRECLAIMER_H
+#endif
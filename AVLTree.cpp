@@ -26,7 +26,16 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>
  * </pre>
  */
+#ifndef AVLTREE_CPP
+#define AVLTREE_CPP
+
 #include "AVLTree.h"
+#include "CountingBloomFilter.cpp"
+#include "AVLWorkPool.cpp"
+#include "KeyNormalizer.cpp"
+#include "StringArena.cpp"
+#include "NodePool.cpp"
+#include "AVLReclaimer.cpp"
 #include <cstdlib>
 #include <iostream>
 #include <queue>
@@ -37,164 +46,727 @@ using namespace std;
 
 /* Nested Node class definitions */
 
-template <typename E>
-AVLTree<E>::Node::Node(E s)
+template <typename E, typename Aug, typename Bal>
+template <typename... Args>
+AVLTree<E,Aug,Bal>::Node::Node(Args&&... args) : data(std::forward<Args>(args)...)
 {
-   data = s;
    left = NULL;
    right = NULL;
-   bal = EH;
+   bal = Bal::LEAF;
+   mult = 1;
+   weight = 1;
+   agg = Aug::of(data);
+}
+
+template <typename E, typename Aug, typename Bal>
+AVLTree<E,Aug,Bal>::Cursor::Cursor()
+{
+   owner = NULL;
+   version = 0;
+   length = 0;
+   matched = false;
+}
+
+template <typename E, typename Aug, typename Bal>
+bool AVLTree<E,Aug,Bal>::Cursor::isValid() const
+{
+   return matched && owner != NULL && owner->version == version;
+}
+
+template <typename E, typename Aug, typename Bal>
+const typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::Cursor::node() const
+{
+   if (!isValid())
+      throw AVLTreeException("AVL Tree Exception: cursor is not at an item of the tree");
+   return path[length - 1];
+}
+
+template <typename E, typename Aug, typename Bal>
+const E& AVLTree<E,Aug,Bal>::Cursor::data() const
+{
+   return node()->data;
+}
+
+template <typename E, typename Aug, typename Bal>
+const E* AVLTree<E,Aug,Bal>::Cursor::parent() const
+{
+   node();
+   return length > 1 ? &path[length - 2]->data : NULL;
+}
+
+template <typename E, typename Aug, typename Bal>
+const E* AVLTree<E,Aug,Bal>::Cursor::left() const
+{
+   const Node* child = node()->left;
+   return child != NULL ? &child->data : NULL;
+}
+
+template <typename E, typename Aug, typename Bal>
+const E* AVLTree<E,Aug,Bal>::Cursor::right() const
+{
+   const Node* child = node()->right;
+   return child != NULL ? &child->data : NULL;
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::Cursor::depth() const
+{
+   node();
+   return length - 1;
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::Cursor::subtreeSize() const
+{
+   return node()->weight;
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::Cursor::descendants() const
+{
+   const Node* at = node();
+   return at->weight - at->mult;
 }
 
 /* Outer AVLTree class definitions */
 
-template <typename E>
-AVLTree<E>::AVLTree()
+template <typename E, typename Aug, typename Bal>
+AVLTree<E,Aug,Bal>::AVLTree()
 {
    root = NULL;
-   count = 0;
-   cmp = [](E a, E b) -> int{return a < b? -1 : (a == b? 0 : 1);};
+   nodeCount = 0;
+   pool = NULL;
+   multiset = false;
+   lazyThreshold = 0;
+   deadCount = 0;
+   version = 0;
+   shapeVersion = numeric_limits<unsigned long>::max();
+   lowest = NULL;
+   highest = NULL;
+   extremesVersion = numeric_limits<unsigned long>::max();
+   keyBytes = 0;
+   keySlack = 0;
+   hotHits = 0;
+   hotMisses = 0;
+   hotInvalidations = 0;
+   filter = NULL;
+   cmp = [](const E& a, const E& b) -> int{return naturalOrder(a, b);};
+   natural = true;
 }
 
-template <typename E>
-AVLTree<E>::AVLTree(std::function<int(E,E)> fn)
+template <typename E, typename Aug, typename Bal>
+AVLTree<E,Aug,Bal>::AVLTree(std::function<int(const E&, const E&)> fn)
 {
     root = NULL;
-    count = 0;
+    nodeCount = 0;
+    pool = NULL;
+    multiset = false;
+    lazyThreshold = 0;
+    deadCount = 0;
+    version = 0;
+    shapeVersion = numeric_limits<unsigned long>::max();
+    lowest = NULL;
+    highest = NULL;
+    extremesVersion = numeric_limits<unsigned long>::max();
+    keyBytes = 0;
+    keySlack = 0;
+    hotHits = 0;
+    hotMisses = 0;
+    hotInvalidations = 0;
+    filter = NULL;
     if (cmp == nullptr) 
         cmp = fn;
+    natural = false;
 }
 
-template <typename E>
-AVLTree<E>::~AVLTree()
+template <typename E, typename Aug, typename Bal>
+AVLTree<E,Aug,Bal>::AVLTree(AVLTree<E,Aug,Bal>&& other) noexcept
 {
-   recDestroy(root);
+   root = NULL;
+   pool = NULL;
+   version = 0;
+   shapeVersion = numeric_limits<unsigned long>::max();
+   lowest = NULL;
+   highest = NULL;
+   extremesVersion = numeric_limits<unsigned long>::max();
+   hotHits = 0;
+   hotMisses = 0;
+   hotInvalidations = 0;
+   filter = NULL;
+   natural = true;
+   *this = std::move(other);
 }
 
+template <typename E, typename Aug, typename Bal>
+AVLTree<E,Aug,Bal>& AVLTree<E,Aug,Bal>::operator=(AVLTree<E,Aug,Bal>&& other) noexcept
+{
+   if (this != &other)
+   {
+      destroy(root, pool);
+      delete pool;
+      root = other.root;
+      nodeCount = other.nodeCount;
+      pool = other.pool;
+      multiset = other.multiset;
+      lazyThreshold = other.lazyThreshold;
+      deadCount = other.deadCount;
+      keyBytes = other.keyBytes;
+      keySlack = other.keySlack;
+      /* swapping never allocates or throws, as copying a comparator
+         can; the emptied tree is left in this tree's old order */
+      cmp.swap(other.cmp);
+      std::swap(natural, other.natural);
+      forgetAll();
+      other.forgetAll();
+      /* the filter counts the nodes, so it goes with them */
+      delete filter;
+      filter = other.filter;
+      filterHash.swap(other.filterHash);
+      other.filter = NULL;
+      version++;
+      other.version++;
+      other.root = NULL;
+      other.nodeCount = 0;
+      other.pool = NULL;
+      other.deadCount = 0;
+      other.keyBytes = 0;
+      other.keySlack = 0;
+   }
+   return *this;
+}
 
-template <typename E>
-bool AVLTree<E>::isEmpty() const
+template <typename E, typename Aug, typename Bal>
+AVLTree<E,Aug,Bal>::~AVLTree()
 {
-   return root == NULL;
+   destroy(root, pool);
+   delete pool;
+   delete filter;
 }
 
-template<typename E>
-void AVLTree<E>::insert(const E& obj)
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::usePool(size_t nodesPerChunk)
 {
-   bool forTaller;
-   Node* newNode = new Node(obj);
-   /* If it is the first node in the tree */
-   if (!inTree(obj))
-      count++;
-   root = insert(root, newNode, forTaller);
+   if (!isEmpty())
+      throw AVLTreeException("AVL Tree Exception: usePool() called on a non-empty tree");
+   delete pool;
+   pool = new NodePool(sizeof(Node), nodesPerChunk);
 }
 
-template<typename E>
-bool AVLTree<E>::inTree(const E& item) const
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::useCache(size_t slots)
 {
-   Node *tmp;
-   if (isEmpty())
-      return false;
-   /*find where it is */
-   tmp = root;
-   while (1)
+   size_t size = 0;
+   if (slots > 0)
+      for (size = 1; size < slots; size *= 2)
+         ;
+   hotKeys.assign(size, HotSlot{NULL, false});
+   hotHits = 0;
+   hotMisses = 0;
+   hotInvalidations = 0;
+}
+
+template <typename E, typename Aug, typename Bal>
+AVLCacheStats AVLTree<E,Aug,Bal>::cacheStats() const
+{
+   AVLCacheStats stats;
+   stats.slots = hotKeys.size();
+   stats.hits = hotHits.load(memory_order_relaxed);
+   stats.misses = hotMisses.load(memory_order_relaxed);
+   stats.invalidations = hotInvalidations;
+   return stats;
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::useFilter(size_t expectedKeys, double falsePositiveRate, size_t maxBytes,
+                                   std::function<size_t(const E&)> hash)
+{
+   if (!natural && !hash)
+      throw AVLTreeException("AVL Tree Exception: useFilter() on a tree with a comparator needs a hash consistent with it");
+   filterHash = hash;
+   if (expectedKeys == 0)
    {
-      if (cmp(tmp->data,item) == 0)
-         return true;
-      if (cmp(tmp->data, item) > 0)
+      delete filter;
+      filter = NULL;
+      return;
+   }
+   refilter(expectedKeys, falsePositiveRate, maxBytes);
+}
+
+template <typename E, typename Aug, typename Bal>
+AVLFilterStats AVLTree<E,Aug,Bal>::filterStats() const
+{
+   if (filter != NULL)
+      return filter->stats();
+   AVLFilterStats stats = AVLFilterStats();
+   return stats;
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::setMultiset(bool enable)
+{
+   if (!isEmpty())
+      throw AVLTreeException("AVL Tree Exception: setMultiset() called on a non-empty tree");
+   multiset = enable;
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::count(const E& key) const
+{
+   Node* tmp = root;
+   while (tmp)
+   {
+      int diff = order(key, tmp->data);
+      if (diff == 0)
+         return tmp->mult;
+      tmp = diff < 0 ? tmp->left : tmp->right;
+   }
+   return 0;
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::occurrences() const
+{
+   return weightOf(root);
+}
+
+template <typename E, typename Aug, typename Bal>
+const E& AVLTree<E,Aug,Bal>::select(int k) const
+{
+   if (k < 0 || k >= weightOf(root))
+      throw AVLTreeException("AVL Tree Exception: rank out of range in call to select()");
+   Node* tmp = root;
+   while (true)
+   {
+      int leftWeight = weightOf(tmp->left);
+      if (k < leftWeight)
+         tmp = tmp->left;
+      else if (k < leftWeight + tmp->mult)
+         return tmp->data;
+      else
       {
-         if (!(tmp->left))
-            return false;
-         /* continue searching */
+         k -= leftWeight + tmp->mult;
+         tmp = tmp->right;
+      }
+   }
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::rank(const E& key) const
+{
+   int preceding = 0;
+   Node* tmp = root;
+   while (tmp)
+   {
+      int diff = order(key, tmp->data);
+      if (diff <= 0)
+      {
+         if (diff == 0)
+            return preceding + weightOf(tmp->left);
          tmp = tmp->left;
       }
       else
       {
-         if (!(tmp->right))
-            return false;
-         /* continue searching for insertion pt. */
+         preceding += weightOf(tmp->left) + tmp->mult;
          tmp = tmp->right;
       }
    }
+   return preceding;
 }
 
-template<typename E>
-void AVLTree<E>::remove(const E& item)
+template <typename E, typename Aug, typename Bal>
+typename Aug::value_type AVLTree<E,Aug,Bal>::aggregate(const E& lo, const E& hi) const
 {
-   bool shorter;
-   bool success;
-   Node* newRoot;
-   if (!inTree(item))
-      return;
-   newRoot = remove(root, item, shorter, success);
-   if (success)
+   /* find the highest node in the range */
+   Node* split = root;
+   while (split)
+   {
+      if (order(split->data, lo) < 0)
+         split = split->right;
+      else if (order(split->data, hi) > 0)
+         split = split->left;
+      else
+         break;
+   }
+   if (split == NULL)
+      return Aug::identity();
+   /* collect the nodes at or above lo on the left boundary, right to left */
+   typename Aug::value_type below = Aug::identity();
+   for (Node* tmp = split->left; tmp; )
+   {
+      if (order(tmp->data, lo) >= 0)
+      {
+         typename Aug::value_type part = valueOf(tmp);
+         if (tmp->right)
+            part = Aug::combine(part, tmp->right->agg);
+         below = Aug::combine(part, below);
+         tmp = tmp->left;
+      }
+      else
+         tmp = tmp->right;
+   }
+   /* collect the nodes at or below hi on the right boundary, left to right */
+   typename Aug::value_type above = Aug::identity();
+   for (Node* tmp = split->right; tmp; )
    {
-      root = newRoot;
-      count--;
+      if (order(tmp->data, hi) <= 0)
+      {
+         typename Aug::value_type part = valueOf(tmp);
+         if (tmp->left)
+            part = Aug::combine(tmp->left->agg, part);
+         above = Aug::combine(above, part);
+         tmp = tmp->right;
+      }
+      else
+         tmp = tmp->left;
    }
+   return Aug::combine(Aug::combine(below, valueOf(split)), above);
 }
 
-template<typename E>
-const E& AVLTree<E>::retrieve(const E& key) const
+template <typename E, typename Aug, typename Bal>
+typename Aug::value_type AVLTree<E,Aug,Bal>::aggregate() const
 {
-   Node* tmp;
-   if (isEmpty())
-      throw AVLTreeException("AVL Tree Exception: tree empty on retrieve()");
-   tmp = root;
-   while(true)
+   return root == NULL ? Aug::identity() : root->agg;
+}
+
+template <typename E, typename Aug, typename Bal>
+template <typename T>
+vector<E> AVLTree<E,Aug,Bal>::overlapping(const T& lo, const T& hi) const
+{
+   vector<E> found;
+   overlapping(root, lo, hi, found);
+   return found;
+}
+
+template <typename E, typename Aug, typename Bal>
+template <typename T>
+vector<E> AVLTree<E,Aug,Bal>::stabbing(const T& point) const
+{
+   return overlapping(point, point);
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::setLazyDelete(double threshold)
+{
+   if (!isEmpty())
+      throw AVLTreeException("AVL Tree Exception: setLazyDelete() called on a non-empty tree");
+   lazyThreshold = threshold;
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::purge()
+{
+   vector<Node*> live;
+   vector<Node*> path;
+   live.reserve(nodeCount);
+   Node* tmp = root;
+   while (tmp || !path.empty())
    {
-      if (cmp(tmp->data,key) == 0)
-         return tmp->data;
-      if (cmp(tmp->data, key) > 0)
+      while (tmp)
       {
-         if (tmp->left == NULL)
-            throw new AVLTreeException("AVL Tree Exception: key not in tree call to retrieve()");
+         path.push_back(tmp);
          tmp = tmp->left;
       }
+      tmp = path.back();
+      path.pop_back();
+      Node* next = tmp->right;
+      if (tmp->mult > 0)
+         live.push_back(tmp);
       else
+         freeNode(tmp);
+      tmp = next;
+   }
+   int height;
+   root = buildBalanced(live, 0, live.size(), height);
+   settle(root, 0, height, Bal());
+   deadCount = 0;
+   version++;
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::eraseRange(const E& lo, const E& hi)
+{
+   return eraseBetween([&](const Node* node) { return order(node->data, lo) < 0; },
+                       [&](const Node* node) { return order(node->data, hi) <= 0; }, Bal());
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::truncateBelow(const E& key)
+{
+   return eraseBetween([](const Node* node) { return false; },
+                       [&](const Node* node) { return order(node->data, key) < 0; }, Bal());
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::truncateAbove(const E& key)
+{
+   return eraseBetween([&](const Node* node) { return order(node->data, key) <= 0; },
+                       [](const Node* node) { return true; }, Bal());
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::clear()
+{
+   Node* detached = root;
+   NodePool* detachedPool = pool;
+   if (pool != NULL)
+      pool = new NodePool(sizeof(Node), pool->blocksPerChunk());
+   root = NULL;
+   nodeCount = 0;
+   deadCount = 0;
+   version++;
+   keyBytes = 0;
+   keySlack = 0;
+   forgetAll();
+   if (filter != NULL)
+      filter->reset();
+   if (detached == NULL && detachedPool == NULL)
+      return;
+   AVLReclaimer::instance().submit([detached, detachedPool]()
       {
-         if (tmp->right ==  NULL)
-            throw new AVLTreeException("AVL Tree Exception: key not in tree call to retrieve()");
-         tmp = tmp->right;
+         destroy(detached, detachedPool);
+         delete detachedPool;
+      });
+}
+
+template <typename E, typename Aug, typename Bal>
+AVLTree<E,Aug,Bal> AVLTree<E,Aug,Bal>::clone() const
+{
+   AVLTree<E,Aug,Bal> copy(cmp);
+   copy.natural = natural;
+   copy.useCache(hotKeys.size());
+   if (filter != NULL)
+      copy.filter = new CountingBloomFilter(*filter);
+   copy.filterHash = filterHash;
+   copy.multiset = multiset;
+   copy.lazyThreshold = lazyThreshold;
+   copy.deadCount = deadCount;
+   int forks = 0;
+   if (nodeCount + deadCount >= PARALLEL_CLONE_SIZE)
+      for (unsigned workers = 1; workers < thread::hardware_concurrency(); workers *= 2)
+         forks++;
+   copy.root = cloneSubtree(root, forks, copy.keyBytes, copy.keySlack);
+   copy.nodeCount = nodeCount;
+   return copy;
+}
+
+
+template <typename E, typename Aug, typename Bal>
+bool AVLTree<E,Aug,Bal>::isEmpty() const
+{
+   return root == NULL;
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::insert(const E& obj)
+{
+   bool extremesKnown = extremesVersion == version;
+   Node* found = findOrInsert([&](const Node* node) { return order(obj, node->data); },
+                [&](Node* node)
+                {
+                   if (node->mult == 0)
+                   {
+                      /* resurrect a lazily deleted node in place */
+                      setData(node, obj);
+                      node->mult = 1;
+                      nodeCount++;
+                      deadCount--;
+                   }
+                   else if (multiset)
+                      node->mult++;
+                   else
+                      setData(node, obj);
+                },
+                [&]() { return newNode(obj); });
+   if (!extremesKnown)
+      return;
+   /* rotations move no data between nodes, so the extremes stay put
+      unless the new key passes one of them */
+   if (lowest == NULL)
+      lowest = highest = found;
+   else if (order(found->data, lowest.load()->data) < 0)
+      lowest = found;
+   else if (order(found->data, highest.load()->data) > 0)
+      highest = found;
+   extremesVersion = version;
+}
+
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Cursor AVLTree<E,Aug,Bal>::insert(const Cursor& hint, const E& obj)
+{
+   if (hint.owner == this && hint.version == version)
+      finger = hint;
+   insert(obj);
+   return finger;
+}
+
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Cursor AVLTree<E,Aug,Bal>::locate(const E& item) const
+{
+   Cursor at;
+   at.owner = this;
+   at.version = version;
+   Node* node = root;
+   while (node)
+   {
+      if (at.length == MAX_DEPTH)
+         throw AVLTreeException("AVL Tree Exception: tree too deep in call to locate()");
+      at.path[at.length++] = node;
+      int diff = order(node->data, item);
+      if (diff == 0)
+      {
+         at.matched = node->mult > 0;
+         break;
       }
+      node = diff > 0 ? node->left : node->right;
+   }
+   return at;
+}
+
+template <typename E, typename Aug, typename Bal>
+bool AVLTree<E,Aug,Bal>::inTree(const E& item) const
+{
+   Node* found = search(item);
+   return found != NULL && found->mult > 0;
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::remove(const E& item)
+{
+   bool extremesKnown = extremesVersion == version;
+   removeMatching([&](const Node* node) { return order(item, node->data); });
+   if (lazyThreshold > 0 && deadCount > lazyThreshold * (nodeCount + deadCount))
+      purge();
+   if (extremesKnown)
+   {
+      /* deleting a node with two children moves its predecessor's data,
+         so the extremes are found again, by weight rather than by key */
+      lowest = seek(FirstLiveProbe());
+      highest = seek(LastLiveProbe());
+      extremesVersion = version;
    }
-   //return tmp->data;
 }
 
-template<typename E>
-void AVLTree<E>::traverse(FuncType func)
+template <typename E, typename Aug, typename Bal>
+const E& AVLTree<E,Aug,Bal>::retrieve(const E& key) const
+{
+   if (isEmpty())
+      throw AVLTreeException("AVL Tree Exception: tree empty on retrieve()");
+   Node* found = search(key);
+   if (found == NULL || found->mult == 0)
+      throw AVLTreeException("AVL Tree Exception: key not in tree call to retrieve()");
+   return found->data;
+}
+
+template <typename E, typename Aug, typename Bal>
+const E& AVLTree<E,Aug,Bal>::findMin() const
+{
+   findExtremes();
+   Node* least = lowest.load(memory_order_relaxed);
+   if (least == NULL)
+      throw AVLTreeException("AVL Tree Exception: tree empty on findMin()");
+   return least->data;
+}
+
+template <typename E, typename Aug, typename Bal>
+const E& AVLTree<E,Aug,Bal>::findMax() const
+{
+   findExtremes();
+   Node* greatest = highest.load(memory_order_relaxed);
+   if (greatest == NULL)
+      throw AVLTreeException("AVL Tree Exception: tree empty on findMax()");
+   return greatest->data;
+}
+
+template <typename E, typename Aug, typename Bal>
+E AVLTree<E,Aug,Bal>::popMin()
+{
+   findExtremes();
+   if (lowest == NULL)
+      throw AVLTreeException("AVL Tree Exception: tree empty on popMin()");
+   Node* popped = lowest;
+   E item = popped->data;
+   removeMatching(FirstLiveProbe());
+   if (lazyThreshold > 0 && deadCount > lazyThreshold * (nodeCount + deadCount))
+      purge();
+   /* the other extreme is untouched unless it was the popped node, the
+      only live key left or none at all */
+   lowest = seek(FirstLiveProbe());
+   if (highest == popped)
+      highest = lowest.load();
+   extremesVersion = version;
+   return item;
+}
+
+template <typename E, typename Aug, typename Bal>
+E AVLTree<E,Aug,Bal>::popMax()
+{
+   findExtremes();
+   if (highest == NULL)
+      throw AVLTreeException("AVL Tree Exception: tree empty on popMax()");
+   Node* popped = highest;
+   E item = popped->data;
+   removeMatching(LastLiveProbe());
+   if (lazyThreshold > 0 && deadCount > lazyThreshold * (nodeCount + deadCount))
+      purge();
+   highest = seek(LastLiveProbe());
+   if (lowest == popped)
+      lowest = highest.load();
+   extremesVersion = version;
+   return item;
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::traverse(FuncType func)
 {
    traverse(root, func); //In-order
 }
 
-template<typename E>
-int AVLTree<E>::size() const
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::size() const
 {
-   return count;
+   return nodeCount;
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::parallelForEach(FuncType func, int grain) const
+{
+   AVLWorkPool::Group group;
+   forEachIn(root, func, grain, group);
+   group.join();
+}
+
+template <typename E, typename Aug, typename Bal>
+vector<E> AVLTree<E,Aug,Bal>::toVector(int grain) const
+{
+   vector<E> items(weightOf(root));
+   AVLWorkPool::Group group;
+   exportSubtree(root, items.data(), grain, group);
+   group.join();
+   return items;
 }
 
 /* BEGIN: Augmented Public Functions */
-template<typename E>
-void AVLTree<E>::preorderTraverse(FuncType func)
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::preorderTraverse(FuncType func)
 {
    preorderTraverse(root, func);
 }
 
-template<typename E>
-void AVLTree<E>::postorderTraverse(FuncType func)
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::postorderTraverse(FuncType func)
 {
    postorderTraverse(root, func);
 }
 
-template<typename E>
-vector<E*> AVLTree<E>::getChildren(E entry) const
+template <typename E, typename Aug, typename Bal>
+vector<E*> AVLTree<E,Aug,Bal>::getChildren(E entry) const
 {
     Node* parent = root;
     std::vector<E*> children;
 
     while (parent) 
     {
-        if (cmp(parent->data, entry) == 0) {
+        if (order(parent->data, entry) == 0) {
             if (parent->left) {
                 children.push_back(&(parent->left->data));
             } else {
@@ -209,7 +781,7 @@ vector<E*> AVLTree<E>::getChildren(E entry) const
 
             return children;
         } 
-        else if (cmp(parent->data, entry) > 0) 
+        else if (order(parent->data, entry) > 0) 
         {
             parent = parent->left;
         } 
@@ -224,20 +796,20 @@ vector<E*> AVLTree<E>::getChildren(E entry) const
 }
 
    
-template <typename E>
-const E* AVLTree<E>::getParent(E entry) const      
+template <typename E, typename Aug, typename Bal>
+const E* AVLTree<E,Aug,Bal>::getParent(E entry) const      
 {
     Node* currentNode = root;
     Node* parentNode = nullptr;
     
     while (currentNode != nullptr)
     {
-        if (cmp(currentNode->data, entry) == 0)
+        if (order(currentNode->data, entry) == 0)
         {
             // Found the node, return its parent
             return (parentNode != nullptr) ? &(parentNode->data) : nullptr;
         }
-        else if (cmp(currentNode->data, entry) > 0)
+        else if (order(currentNode->data, entry) > 0)
         {
             // Traverse left
             parentNode = currentNode;
@@ -256,195 +828,876 @@ const E* AVLTree<E>::getParent(E entry) const
 }   
    
 
-template <typename E>
-int AVLTree<E>::ancestors(E entry) const
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::ancestors(E entry) const
 {
-    if (!inTree(entry)) {
+    Cursor at = locate(entry);
+    if (!at.isValid()) {
         throw AVLTreeException("Entry is not in the tree");
     }
+    return at.depth();
+}
 
-    int numberAncestors = 0;
-    Node* currentNode = root;
-
-    while (currentNode) {
-        if (cmp(currentNode->data, entry) == 0) 
-        {
-            // Found the node with the specified entry
-            int heightOfNode = height(currentNode);
-            return height(root) - heightOfNode;
-        } 
-        else if (cmp(currentNode->data, entry) > 0) 
-        {
-            currentNode = currentNode->left;
-        } 
-        else 
-        {
-            currentNode = currentNode->right;
-        }
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::descendants(E entry) const
+{
+    Cursor at = locate(entry);
+    if (!at.isValid()) 
+    {
+        throw AVLTreeException("Entry is not in the tree");
     }
+    return at.descendants();
+}
 
-    // If entry is not found, throw an exception or handle it as needed.
-    throw AVLTreeException("AVLTreeException: Entry not found in the tree");
+
+template <typename E, typename Aug, typename Bal>
+bool AVLTree<E,Aug,Bal>::isFibonacci() const
+{
+   int fib = fibonacci(shapeOf().height + 3) - 1;
+
+   if (fib == nodeCount + deadCount)
+   {
+      return true;
+   }
+
+   return false;    
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::height() const
+{
+    return shapeOf().height;
 }
 
-template <typename E>
-int AVLTree<E>::descendants(E entry) const
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::diameter() const
 {
-    if (!inTree(entry)) 
+
+    if (root == nullptr)
     {
-        throw AVLTreeException("Entry is not in the tree");
+        return 0;
     }
+    Shape measured = shapeOf();
+    return measured.leftHeight + measured.rightHeight + 3;
+}
 
-    Node* currentNode = root;
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::fibonacci(int n)
+{
+   /* every term that fits in an int */
+   static const vector<int> table = []()
+      {
+         vector<int> terms = {0, 1};
+         while (terms.back() <= numeric_limits<int>::max() - terms[terms.size() - 2])
+            terms.push_back(terms.back() + terms[terms.size() - 2]);
+         return terms;
+      }();
+   if (n < 0 || n >= (int)table.size())
+      return -1;
+   return table[n];
+}
 
-    while (currentNode) {
-        if (cmp(currentNode->data, entry) == 0) {
-            // Found the node with the specified entry
-            return countDesc(currentNode);
-        } else if (cmp(currentNode->data, entry) > 0) {
-            currentNode = currentNode->left;
-        } else {
-            currentNode = currentNode->right;
-        }
-    }
+template <typename E, typename Aug, typename Bal>
+bool AVLTree<E,Aug,Bal>::isComplete() const
+{
+    return shapeOf().complete;
+}
 
-    // If entry is not found, throw an exception or handle it as needed.
-    throw AVLTreeException("AVLTreeException: Entry not found in the tree");
+template <typename E, typename Aug, typename Bal>
+AVLMemoryUsage AVLTree<E,Aug,Bal>::memoryUsage() const
+{
+   AVLMemoryUsage usage;
+   usage.nodes = nodeCount + deadCount;
+   usage.nodeBytes = usage.nodes * sizeof(Node);
+   usage.keyBytes = keyBytes;
+   if (pool != NULL)
+      usage.allocatorBytes = pool->slack(sizeof(Node)) + keySlack;
+   else
+      usage.allocatorBytes = usage.nodes * allocatorOverhead(sizeof(Node)) + keySlack;
+   return usage;
 }
+/* END: Augmented Public Functions */
 
 
-template <typename E>
-bool AVLTree<E>::isFibonacci() const
+/* Private functions */
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::destroy(Node* root, NodePool* nodePool)
 {
-   int fib = fibonacci(height(root) + 3) - 1;
+   if (nodePool != NULL && is_trivially_destructible<E>::value)
+   {
+      nodePool->release();
+      return;
+   }
+   while (root)
+   {
+      if (root->left)
+      {
+         /* rotate right so that the left subtree joins the right spine */
+         Node* tmp = root->left;
+         root->left = tmp->right;
+         tmp->right = root;
+         root = tmp;
+      }
+      else
+      {
+         Node* next = root->right;
+         if (nodePool != NULL)
+            root->~Node();
+         else
+            delete root;
+         root = next;
+      }
+   }
+   if (nodePool != NULL)
+      nodePool->release();
+}
 
-   if (fib == size())
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::cloneSubtree(const Node* node, int forks, size_t& bytes, size_t& slack)
+{
+   if (node == NULL)
+      return NULL;
+   Node* copy = new Node(node->data);
+   copy->bal = node->bal;
+   copy->mult = node->mult;
+   copy->weight = node->weight;
+   copy->agg = node->agg;
+   bytes += keyHeapBytes(copy->data);
+   slack += allocatorOverhead(keyHeapBytes(copy->data));
+   /* when a copy of an element throws, the part of the subtree copied
+      so far is freed before the exception goes on */
+   try
    {
-      return true;
+      if (forks > 0)
+      {
+         size_t leftBytes = 0;
+         size_t leftSlack = 0;
+         future<Node*> left = async(launch::async, [&]()
+            {
+               return cloneSubtree(node->left, forks - 1, leftBytes, leftSlack);
+            });
+         try
+         {
+            copy->right = cloneSubtree(node->right, forks - 1, bytes, slack);
+         }
+         catch (...)
+         {
+            try
+            {
+               destroy(left.get(), NULL);
+            }
+            catch (...)
+            {
+            }
+            throw;
+         }
+         copy->left = left.get();
+         bytes += leftBytes;
+         slack += leftSlack;
+      }
+      else
+      {
+         copy->left = cloneSubtree(node->left, 0, bytes, slack);
+         copy->right = cloneSubtree(node->right, 0, bytes, slack);
+      }
    }
+   catch (...)
+   {
+      destroy(copy, NULL);
+      throw;
+   }
+   return copy;
+}
 
-   return false;    
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::forEachIn(const Node* node, const FuncType& func, int grain, AVLWorkPool::Group& group)
+{
+   while (node)
+   {
+      if (node->weight <= grain)
+      {
+         forEachIn(node->left, func, grain, group);
+         if (node->mult > 0)
+            func(node->data);
+         node = node->right;
+         continue;
+      }
+      const Node* left = node->left;
+      group.fork([left, &func, grain, &group]() { forEachIn(left, func, grain, group); });
+      if (node->mult > 0)
+         func(node->data);
+      node = node->right;
+   }
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::exportSubtree(const Node* node, E* out, int grain, AVLWorkPool::Group& group)
+{
+   while (node)
+   {
+      const Node* left = node->left;
+      if (node->weight > grain)
+         group.fork([left, out, grain, &group]() { exportSubtree(left, out, grain, group); });
+      else
+         exportSubtree(left, out, grain, group);
+      out += weightOf(left);
+      for (int k = 0; k < node->mult; k++)
+         *out++ = node->data;
+      node = node->right;
+   }
+}
+
+template <typename E, typename Aug, typename Bal>
+template <typename T>
+void AVLTree<E,Aug,Bal>::overlapping(const Node* node, const T& lo, const T& hi, vector<E>& found)
+{
+   if (node == NULL || node->agg < lo)
+      return;
+   overlapping(node->left, lo, hi, found);
+   if (hi < node->data.first)
+      return;
+   if (node->mult > 0 && !(node->data.second < lo))
+      found.push_back(node->data);
+   overlapping(node->right, lo, hi, found);
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::refresh(Node* node)
+{
+   node->weight = node->mult + weightOf(node->left) + weightOf(node->right);
+   node->agg = valueOf(node);
+   if (node->left)
+      node->agg = Aug::combine(node->left->agg, node->agg);
+   if (node->right)
+      node->agg = Aug::combine(node->agg, node->right->agg);
+}
+
+template <typename E, typename Aug, typename Bal>
+typename Aug::value_type AVLTree<E,Aug,Bal>::valueOf(const Node* node)
+{
+   if (node->mult <= 1)
+      return node->mult > 0 ? Aug::of(node->data) : Aug::identity();
+   typename Aug::value_type value = Aug::identity();
+   typename Aug::value_type power = Aug::of(node->data);
+   for (int m = node->mult; m > 0; m >>= 1)
+   {
+      if (m & 1)
+         value = Aug::combine(value, power);
+      if (m > 1)
+         power = Aug::combine(power, power);
+   }
+   return value;
+}
+
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::buildBalanced(const vector<Node*>& nodes, size_t first, size_t last, int& height)
+{
+   if (first >= last)
+   {
+      height = -1;
+      return NULL;
+   }
+   /* the left half is never larger, so neither is its height */
+   size_t mid = first + (last - first - 1) / 2;
+   Node* node = nodes[mid];
+   int leftHeight;
+   int rightHeight;
+   node->left = buildBalanced(nodes, first, mid, leftHeight);
+   node->right = buildBalanced(nodes, mid + 1, last, rightHeight);
+   node->bal = rightHeight > leftHeight ? RH : EH;
+   height = max(leftHeight, rightHeight) + 1;
+   refresh(node);
+   return node;
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::heightOf(const Node* node)
+{
+   int height = -1;
+   while (node)
+   {
+      height++;
+      node = node->bal == LH ? node->left : node->right;
+   }
+   return height;
+}
+
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::join(Node* left, Node* mid, Node* right)
+{
+   bool taller;
+   int leftHeight = heightOf(left);
+   int rightHeight = heightOf(right);
+   if (leftHeight > rightHeight + 1)
+      return joinRight(left, leftHeight, mid, right, rightHeight, taller);
+   if (rightHeight > leftHeight + 1)
+      return joinLeft(left, leftHeight, mid, right, rightHeight, taller);
+   mid->left = left;
+   mid->right = right;
+   mid->bal = rightHeight > leftHeight ? RH : (leftHeight > rightHeight ? LH : EH);
+   refresh(mid);
+   return mid;
+}
+
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::joinRight(Node* node, int nodeHeight, Node* mid, Node* right, int rightHeight, bool& taller)
+{
+   Node* child = node->right;
+   int childHeight = nodeHeight - (node->bal == LH ? 2 : 1);
+   if (childHeight <= rightHeight + 1)
+   {
+      mid->left = child;
+      mid->right = right;
+      mid->bal = childHeight > rightHeight ? LH : EH;
+      refresh(mid);
+      node->right = mid;
+      taller = true;
+   }
+   else
+      node->right = joinRight(child, childHeight, mid, right, rightHeight, taller);
+   if (taller)
+      switch(node->bal)
+      {
+         case LH: // was left-high -- now EH
+            node->bal = EH;
+            taller = false;
+            break;
+         case EH: // was balanced -- now RH
+            node->bal = RH;
+            break;
+         case RH: // was right-high -- rotate
+            if (node->right->bal == EH)
+            {
+               /* only a join leaves a balanced taller child; the rotated
+                  subtree stays one level taller */
+               node->bal = RH;
+               node->right->bal = LH;
+               node = rotateLeft(node);
+            }
+            else
+               node = rightBalance(node, taller);
+            break;
+      }
+   refresh(node);
+   return node;
+}
+
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::joinLeft(Node* left, int leftHeight, Node* mid, Node* node, int nodeHeight, bool& taller)
+{
+   Node* child = node->left;
+   int childHeight = nodeHeight - (node->bal == RH ? 2 : 1);
+   if (childHeight <= leftHeight + 1)
+   {
+      mid->left = left;
+      mid->right = child;
+      mid->bal = childHeight > leftHeight ? RH : EH;
+      refresh(mid);
+      node->left = mid;
+      taller = true;
+   }
+   else
+      node->left = joinLeft(left, leftHeight, mid, child, childHeight, taller);
+   if (taller)
+      switch(node->bal)
+      {
+         case RH: // was right-high -- now EH
+            node->bal = EH;
+            taller = false;
+            break;
+         case EH: // was balanced -- now LH
+            node->bal = LH;
+            break;
+         case LH: // was left-high -- rotate
+            if (node->left->bal == EH)
+            {
+               node->bal = LH;
+               node->left->bal = RH;
+               node = rotateRight(node);
+            }
+            else
+               node = leftBalance(node, taller);
+            break;
+      }
+   refresh(node);
+   return node;
+}
+
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::concat(Node* left, Node* right)
+{
+   if (left == NULL)
+      return right;
+   if (right == NULL)
+      return left;
+   Node* min;
+   bool shorter;
+   right = detachMin(right, min, shorter);
+   return join(left, min, right);
+}
+
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::detachMin(Node* node, Node*& min, bool& shorter)
+{
+   if (node->left == NULL)
+   {
+      min = node;
+      shorter = true;
+      return node->right;
+   }
+   node->left = detachMin(node->left, min, shorter);
+   if (shorter)
+      node = deleteRightBalance(node, shorter);
+   refresh(node);
+   return node;
+}
+
+template <typename E, typename Aug, typename Bal>
+template <typename Before>
+void AVLTree<E,Aug,Bal>::split(Node* node, const Before& before, Node*& left, Node*& right)
+{
+   if (node == NULL)
+   {
+      left = NULL;
+      right = NULL;
+      return;
+   }
+   Node* lower = node->left;
+   Node* upper = node->right;
+   if (before(node))
+   {
+      Node* upperLeft;
+      split(upper, before, upperLeft, right);
+      left = join(lower, node, upperLeft);
+   }
+   else
+   {
+      Node* lowerRight;
+      split(lower, before, left, lowerRight);
+      right = join(lowerRight, node, upper);
+   }
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::freeSubtree(Node* node, int& live, int& dead)
+{
+   while (node)
+   {
+      if (node->left)
+      {
+         Node* tmp = node->left;
+         node->left = tmp->right;
+         tmp->right = node;
+         node = tmp;
+      }
+      else
+      {
+         Node* next = node->right;
+         if (node->mult > 0)
+            live++;
+         else
+            dead++;
+         freeNode(node);
+         node = next;
+      }
+   }
+}
+
+template <typename E, typename Aug, typename Bal>
+template <typename Below, typename Through>
+int AVLTree<E,Aug,Bal>::eraseBetween(const Below& below, const Through& through, AVLBalance)
+{
+   Node* lower;
+   Node* rest;
+   Node* range;
+   Node* upper;
+   split(root, below, lower, rest);
+   split(rest, through, range, upper);
+   root = concat(lower, upper);
+   version++;
+   int live = 0;
+   int dead = 0;
+   freeSubtree(range, live, dead);
+   nodeCount -= live;
+   deadCount -= dead;
+   return live;
+}
+
+template <typename E, typename Aug, typename Bal>
+template <typename Below, typename Through, typename Policy>
+int AVLTree<E,Aug,Bal>::eraseBetween(const Below& below, const Through& through, Policy)
+{
+   vector<Node*> kept;
+   vector<Node*> path;
+   kept.reserve(nodeCount + deadCount);
+   int live = 0;
+   Node* tmp = root;
+   while (tmp || !path.empty())
+   {
+      while (tmp)
+      {
+         path.push_back(tmp);
+         tmp = tmp->left;
+      }
+      tmp = path.back();
+      path.pop_back();
+      Node* next = tmp->right;
+      if (below(tmp) || !through(tmp))
+         kept.push_back(tmp);
+      else
+      {
+         if (tmp->mult > 0)
+         {
+            live++;
+            nodeCount--;
+         }
+         else
+            deadCount--;
+         freeNode(tmp);
+      }
+      tmp = next;
+   }
+   int height;
+   root = buildBalanced(kept, 0, kept.size(), height);
+   settle(root, 0, height, Bal());
+   version++;
+   return live;
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::weightOf(const Node* node)
+{
+   return node == NULL ? 0 : node->weight;
+}
+
+template <typename E, typename Aug, typename Bal>
+template<typename... Args>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::newNode(Args&&... args)
+{
+   Node* node = pool != NULL ? new (pool->allocate()) Node(std::forward<Args>(args)...)
+                             : new Node(std::forward<Args>(args)...);
+   size_t bytes = keyHeapBytes(node->data);
+   keyBytes += bytes;
+   keySlack += allocatorOverhead(bytes);
+   if (filter != NULL)
+   {
+      /* the new node is not linked yet, so grow the filter before
+         counting it rather than after */
+      if (filter->overloaded())
+         refilter(2 * filter->size(), filter->targetRate(), filter->maxBytes());
+      filter->add(filterKey(node->data));
+   }
+   return node;
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::freeNode(Node* node)
+{
+   forget(node);
+   if (filter != NULL)
+      filter->remove(filterKey(node->data));
+   size_t bytes = keyHeapBytes(node->data);
+   keyBytes -= bytes;
+   keySlack -= allocatorOverhead(bytes);
+   if (pool != NULL)
+   {
+      node->~Node();
+      pool->deallocate(node);
+   }
+   else
+      delete node;
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::setData(Node* node, const E& item)
+{
+   forget(node);
+   if (filter != NULL)
+   {
+      filter->remove(filterKey(node->data));
+      filter->add(filterKey(item));
+   }
+   size_t bytes = keyHeapBytes(node->data);
+   keyBytes -= bytes;
+   keySlack -= allocatorOverhead(bytes);
+   node->data = item;
+   bytes = keyHeapBytes(node->data);
+   keyBytes += bytes;
+   keySlack += allocatorOverhead(bytes);
+}
+
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::search(const E& item) const
+{
+   size_t hash = 0;
+   if (!hotKeys.empty())
+   {
+      hash = keyHash(item);
+      HotSlot& cached = hotKeys[hash & (hotKeys.size() - 1)];
+      Node* node = cached.node.load(memory_order_relaxed);
+      if (node != NULL && order(node->data, item) == 0)
+      {
+         hotHits.fetch_add(1, memory_order_relaxed);
+         cached.referenced.store(true, memory_order_relaxed);
+         return node;
+      }
+      hotMisses.fetch_add(1, memory_order_relaxed);
+   }
+   if (filter != NULL)
+   {
+      size_t code = filterHash || hotKeys.empty() ? filterKey(item) : hash;
+      if (!filter->mayContain(code))
+         return NULL;
+   }
+   Node* tmp = root;
+   while (tmp != NULL)
+   {
+      int diff = order(tmp->data, item);
+      if (diff == 0)
+         break;
+      tmp = diff > 0 ? tmp->left : tmp->right;
+   }
+   if (filter != NULL && (tmp == NULL || tmp->mult == 0))
+      filter->falsePositives.fetch_add(1, memory_order_relaxed);
+   /* a node is filed under the hash of its own key, the slot forget()
+      clears; under a comparator coarser than equality the search key may
+      hash elsewhere */
+   if (tmp != NULL && !hotKeys.empty())
+   {
+      if (!natural)
+         hash = keyHash(tmp->data);
+      HotSlot& slot = hotKeys[hash & (hotKeys.size() - 1)];
+      if (slot.referenced.load(memory_order_relaxed))
+         slot.referenced.store(false, memory_order_relaxed);
+      else
+         slot.node.store(tmp, memory_order_relaxed);
+   }
+   return tmp;
+}
+
+template <typename E, typename Aug, typename Bal>
+template<typename Probe>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::seek(const Probe& probe) const
+{
+   Node* node = root;
+   while (node != NULL)
+   {
+      int diff = probe(node);
+      if (diff == 0)
+         return node;
+      node = diff < 0 ? node->left : node->right;
+   }
+   return NULL;
 }
 
-template<typename E>
-int AVLTree<E>::height() const
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::findExtremes() const
 {
-    return height(root);
+   if (extremesVersion.load(memory_order_acquire) == version)
+      return;
+   /* racing readers store the same nodes, since none of them changes
+      the tree */
+   lowest.store(seek(FirstLiveProbe()), memory_order_relaxed);
+   highest.store(seek(LastLiveProbe()), memory_order_relaxed);
+   extremesVersion.store(version, memory_order_release);
 }
 
-template<typename E>
-int AVLTree<E>::diameter() const
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::forget(const Node* node)
 {
-
-    if (root == nullptr)
-    {
-        return 0;
-    }
-    else 
-   return height(root->left) + height(root->right) + 3;
+   if (hotKeys.empty())
+      return;
+   HotSlot& slot = hotKeys[keyHash(node->data) & (hotKeys.size() - 1)];
+   if (slot.node.load(memory_order_relaxed) == node)
+   {
+      slot.node.store(NULL, memory_order_relaxed);
+      slot.referenced.store(false, memory_order_relaxed);
+      hotInvalidations++;
+   }
 }
 
-template <typename E>
-int AVLTree<E>::fibonacci(int n)
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::forgetAll()
 {
-   if (n == 0)
-   {
-      return 0;
-   }
+   fill(hotKeys.begin(), hotKeys.end(), HotSlot{NULL, false});
+}
 
-   else if (n == 1)
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::refilter(size_t expectedKeys, double falsePositiveRate, size_t maxBytes)
+{
+   size_t nodes = nodeCount + deadCount;
+   CountingBloomFilter* fresh = new CountingBloomFilter(expectedKeys > nodes ? expectedKeys : nodes,
+                                                        falsePositiveRate, maxBytes);
+   vector<const Node*> path;
+   if (root != NULL)
+      path.push_back(root);
+   while (!path.empty())
    {
-      return 1;
+      const Node* node = path.back();
+      path.pop_back();
+      fresh->add(filterKey(node->data));
+      if (node->left != NULL)
+         path.push_back(node->left);
+      if (node->right != NULL)
+         path.push_back(node->right);
    }
-
-   else
+   if (filter != NULL)
    {
-      return fibonacci(n - 1) + fibonacci(n - 2);
+      fresh->queries.store(filter->queries.load(memory_order_relaxed), memory_order_relaxed);
+      fresh->rejections.store(filter->rejections.load(memory_order_relaxed), memory_order_relaxed);
+      fresh->falsePositives.store(filter->falsePositives.load(memory_order_relaxed), memory_order_relaxed);
    }
+   delete filter;
+   filter = fresh;
 }
 
-template <typename E>
-bool AVLTree<E>::isComplete() const
+template <typename E, typename Aug, typename Bal>
+template<typename Probe, typename Hit, typename Miss>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::findOrInsert(const Probe& probe, const Hit& hit, const Miss& miss)
 {
-    if (root == nullptr) 
-        return true;
-    return isComplete(root,0);
+   return findOrInsert(finger, probe, hit, miss);
 }
-/* END: Augmented Public Functions */
 
-
-/* Private functions */
-
-template<typename E>
-void AVLTree<E>::recDestroy(Node* root)
+template <typename E, typename Aug, typename Bal>
+template<typename Probe>
+int AVLTree<E,Aug,Bal>::reach(const Cursor& at, const Probe& probe) const
 {
-   if (root)
+   /* the ancestors that bound the subtree of each node from below and above */
+   int lower[MAX_DEPTH];
+   int upper[MAX_DEPTH];
+   int lo = -1;
+   int hi = -1;
+   for (int k = 0; k < at.length; k++)
+   {
+      lower[k] = lo;
+      upper[k] = hi;
+      if (k + 1 < at.length)
+      {
+         if (at.path[k + 1] == at.path[k]->right)
+            lo = k;
+         else
+            hi = k;
+      }
+   }
+   /* the outcome of comparing the key with each ancestor, once each;
+      the side that last failed is tried first since it tends to fail again */
+   int side[MAX_DEPTH];
+   bool known[MAX_DEPTH] = {false};
+   bool upperFirst = false;
+   auto within = [&](int bound, bool isUpper)
+   {
+      if (bound < 0)
+         return true;
+      if (!known[bound])
+      {
+         side[bound] = probe(at.path[bound]);
+         known[bound] = true;
+      }
+      if (isUpper ? side[bound] < 0 : side[bound] > 0)
+         return true;
+      upperFirst = isUpper;
+      return false;
+   };
+   auto spans = [&](int k)
+   {
+      if (upperFirst)
+         return within(upper[k - 1], true) && within(lower[k - 1], false);
+      return within(lower[k - 1], false) && within(upper[k - 1], true);
+   };
+   /* a node spans the key only if its ancestors do, so gallop up from
+      the bottom of the path and then binary search the last step */
+   int found = at.length;
+   int step = 1;
+   while (found > 1 && !spans(found))
+   {
+      found = found - step > 1 ? found - step : 1;
+      step *= 2;
+   }
+   int miss = found + step / 2;
+   if (miss > at.length)
+      miss = at.length + 1;
+   while (miss - found > 1)
    {
-      if (root->left) recDestroy(root->left);
-      if (root->right) recDestroy(root->right);
-      delete root;
+      int mid = (found + miss) / 2;
+      if (spans(mid))
+         found = mid;
+      else
+         miss = mid;
    }
-   return;
+   return found;
 }
 
-template<typename E>
-typename AVLTree<E>::Node* AVLTree<E>::insert(Node* curRoot, Node* newNode, bool& taller)
+template <typename E, typename Aug, typename Bal>
+template<typename Probe, typename Hit, typename Miss>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::findOrInsert(Cursor& at, const Probe& probe, const Hit& hit, const Miss& miss)
 {
-   if (curRoot == NULL)
-   {
-      curRoot = newNode;
-      taller = true;
-      return curRoot;
-   }
-   if (cmp(newNode->data,curRoot->data) < 0)
+   Node** path = at.path;
+   int length = at.owner == this && at.version == version ? reach(at, probe) : 0;
+   at.owner = this;
+   if (length == 0)
    {
-      curRoot->left = insert(curRoot->left,newNode, taller);
-      if (taller)
-         switch(curRoot->bal)
-         {
-            case LH: // was left-high -- rotate
-               curRoot = leftBalance(curRoot, taller);
-               break;
-            case EH: //was balanced -- now LH
-               curRoot->bal = LH;
-               break;  
-            case RH: //was right-high -- now EH
-               curRoot->bal = EH;
-               taller = false;
-               break;
-         }
-      return curRoot;
+      if (root == NULL)
+      {
+         root = miss();
+         nodeCount++;
+         path[0] = root;
+         at.length = rebalanceInsert(path, 1, Bal());
+         at.matched = true;
+         at.version = ++version;
+         return root;
+      }
+      path[length++] = root;
    }
-   if (cmp(newNode->data,curRoot->data) > 0)
+   Node* found;
+   while (true)
    {
-      curRoot->right = insert(curRoot->right,newNode,taller);
-      if (taller)
-         switch(curRoot->bal)
+      Node* curRoot = path[length - 1];
+      int diff = probe(curRoot);
+      if (diff == 0)
+      {
+         hit(curRoot);
+         found = curRoot;
+         for (int k = length - 1; k >= 0; k--)
+            refresh(path[k]);
+         break;
+      }
+      /* both the next node and a new leaf take another path entry */
+      if (length == MAX_DEPTH)
+         throw AVLTreeException("AVL Tree Exception: tree too deep in call to insert()");
+      Node* next = diff < 0 ? curRoot->left : curRoot->right;
+      if (next == NULL)
+      {
+         found = miss();
+         nodeCount++;
+         if (diff < 0)
+            curRoot->left = found;
+         else
+            curRoot->right = found;
+         path[length++] = found;
+         for (int k = length - 2; k >= 0; k--)
+            refresh(path[k]);
+         length = rebalanceInsert(path, length, Bal());
+         /* a rotation cuts the path above the new node; extend it back
+            down so that the cursor stays at the inserted item */
+         while (path[length - 1] != found && length < MAX_DEPTH)
          {
-            case LH: // was left-high -- now EH
-               curRoot->bal = EH;
-               taller=false;
-               break;
-           case EH: // was balance -- now RH
-              curRoot->bal = RH;
-              break;
-           case RH: //was right high -- rotate
-              curRoot = rightBalance(curRoot,taller);
-              break;
+            Node* last = path[length - 1];
+            path[length] = probe(last) < 0 ? last->left : last->right;
+            length++;
          }
-      return curRoot;
-   }
-   else
-   {
-      curRoot->data = newNode->data;
-      delete newNode;
-      taller = false;
-      return curRoot;
+         break;
+      }
+      path[length++] = next;
    }
+   at.length = length;
+   at.matched = path[length - 1] == found;
+   at.version = ++version;
+   return found;
 }
 
-template<typename E>
-typename AVLTree<E>::Node* AVLTree<E>::leftBalance(Node* curRoot, bool& taller)
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::leftBalance(Node* curRoot, bool& taller)
 {
    Node* rightTree;
    Node* leftTree;   
@@ -489,8 +1742,8 @@ typename AVLTree<E>::Node* AVLTree<E>::leftBalance(Node* curRoot, bool& taller)
    return curRoot;
 }
 
-template<typename E>
-typename AVLTree<E>::Node* AVLTree<E>::rightBalance(Node* curRoot, bool& taller)
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::rightBalance(Node* curRoot, bool& taller)
 {
    Node* rightTree;
    Node* leftTree;
@@ -535,41 +1788,442 @@ typename AVLTree<E>::Node* AVLTree<E>::rightBalance(Node* curRoot, bool& taller)
    return curRoot;
 }
 
-template<typename E>
-typename AVLTree<E>::Node* AVLTree<E>::rotateLeft(Node* node)
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::rotateLeft(Node* node)
 {
    Node* tmp;
    tmp = node->right; 
    node->right = tmp->left;
    tmp->left = node;
+   refresh(node);
+   refresh(tmp);
    return tmp;
 }
 
-template<typename E>
-typename AVLTree<E>::Node* AVLTree<E>::rotateRight(Node* node)
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::rotateRight(Node* node)
 {
    Node* tmp;
    tmp = node->left;
    node->left = tmp->right;
    tmp->right = node;
+   refresh(node);
+   refresh(tmp);
    return tmp;
 }   
 
 
-template<typename E>
-void AVLTree<E>::traverse(Node* node, FuncType func)
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::traverse(Node* node, FuncType func)
 {
    if (node)
    {
       traverse(node->left,func);
-      func(node->data);
+      if (node->mult > 0)
+         func(node->data);
       traverse(node->right,func);
    }
 }
 
 
-template<typename E>
-typename AVLTree<E>::Node* AVLTree<E>::remove(Node* node,const E& key, bool& shorter, bool& success)
+template <typename E, typename Aug, typename Bal>
+template<typename Probe>
+bool AVLTree<E,Aug,Bal>::removeMatching(const Probe& probe)
+{
+   return removeMatching(probe, Bal());
+}
+
+template <typename E, typename Aug, typename Bal>
+template<typename Probe>
+bool AVLTree<E,Aug,Bal>::removeMatching(const Probe& probe, AVLBalance)
+{
+   bool shorter;
+   bool success;
+   root = remove(root, probe, shorter, success);
+   version++;
+   return success;
+}
+
+template <typename E, typename Aug, typename Bal>
+template<typename Probe, typename Policy>
+bool AVLTree<E,Aug,Bal>::removeMatching(const Probe& probe, Policy)
+{
+   Node* path[MAX_DEPTH];
+   int length = 0;
+   Node* node = root;
+   while (node)
+   {
+      if (length == MAX_DEPTH)
+         throw AVLTreeException("AVL Tree Exception: tree too deep in call to remove()");
+      path[length++] = node;
+      int diff = probe(node);
+      if (diff == 0)
+         break;
+      node = diff < 0 ? node->left : node->right;
+   }
+   version++;
+   if (node == NULL || node->mult == 0)
+      return false;
+   if (node->mult > 1 || lazyThreshold > 0)
+   {
+      node->mult--;
+      if (node->mult == 0)
+      {
+         nodeCount--;
+         deadCount++;
+      }
+      for (int k = length - 1; k >= 0; k--)
+         refresh(path[k]);
+      return true;
+   }
+   if (node->left != NULL && node->right != NULL)
+   {
+      /* unlink the in-order predecessor instead, after moving its data up */
+      Node* exchPtr = node->left;
+      while (true)
+      {
+         if (length == MAX_DEPTH)
+            throw AVLTreeException("AVL Tree Exception: tree too deep in call to remove()");
+         path[length++] = exchPtr;
+         if (exchPtr->right == NULL)
+            break;
+         exchPtr = exchPtr->right;
+      }
+      setData(node, exchPtr->data);
+      node->mult = exchPtr->mult;
+   }
+   Node* delPtr = path[--length];
+   Node* parent = length > 0 ? path[length - 1] : NULL;
+   bool fromLeft = parent != NULL && parent->left == delPtr;
+   relink(parent, delPtr, delPtr->left != NULL ? delPtr->left : delPtr->right);
+   for (int k = length - 1; k >= 0; k--)
+      refresh(path[k]);
+   rebalanceRemove(path, length, delPtr, fromLeft, Policy());
+   freeNode(delPtr);
+   nodeCount--;
+   return true;
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::rebalanceInsert(Node** path, int length, AVLBalance)
+{
+   bool taller = true;
+   for (int k = length - 2; k >= 0 && taller; k--)
+   {
+      Node* curRoot = path[k];
+      Node* subRoot = curRoot;
+      if (curRoot->left == path[k + 1])
+         switch(curRoot->bal)
+         {
+            case LH: // was left-high -- rotate
+               subRoot = leftBalance(curRoot, taller);
+               break;
+            case EH: //was balanced -- now LH
+               curRoot->bal = LH;
+               break;  
+            case RH: //was right-high -- now EH
+               curRoot->bal = EH;
+               taller = false;
+               break;
+         }
+      else
+         switch(curRoot->bal)
+         {
+            case LH: // was left-high -- now EH
+               curRoot->bal = EH;
+               taller=false;
+               break;
+            case EH: // was balance -- now RH
+               curRoot->bal = RH;
+               break;
+            case RH: //was right high -- rotate
+               subRoot = rightBalance(curRoot,taller);
+               break;
+         }
+      if (subRoot != curRoot)
+      {
+         /* a rotation cuts the path at the new root of the subtree */
+         relink(k > 0 ? path[k - 1] : NULL, curRoot, subRoot);
+         path[k] = subRoot;
+         length = k + 1;
+      }
+   }
+   return length;
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::rebalanceInsert(Node** path, int length, WAVLBalance)
+{
+   /* climb while the node at k has the same rank as its parent */
+   for (int k = length - 1; k > 0; k--)
+   {
+      Node* node = path[k];
+      Node* parent = path[k - 1];
+      if (parent->bal != node->bal)
+         break;
+      bool isLeft = parent->left == node;
+      Node* sibling = isLeft ? parent->right : parent->left;
+      if (parent->bal - rankOf(sibling) == 1)
+      {
+         parent->bal++;
+         continue;
+      }
+      /* the sibling is a 2-child: rotate node up, or its inner child */
+      Node* inner = isLeft ? node->right : node->left;
+      Node* subRoot;
+      if (node->bal - rankOf(inner) == 2)
+      {
+         subRoot = isLeft ? rotateRight(parent) : rotateLeft(parent);
+         parent->bal--;
+      }
+      else
+      {
+         if (isLeft)
+         {
+            parent->left = rotateLeft(node);
+            subRoot = rotateRight(parent);
+         }
+         else
+         {
+            parent->right = rotateRight(node);
+            subRoot = rotateLeft(parent);
+         }
+         inner->bal++;
+         node->bal--;
+         parent->bal--;
+      }
+      relink(k > 1 ? path[k - 2] : NULL, parent, subRoot);
+      path[k - 1] = subRoot;
+      return k;
+   }
+   return length;
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::rebalanceInsert(Node** path, int length, RedBlackBalance)
+{
+   int k = length - 1;
+   /* a red node with a red parent: the root is black, so the parent has a parent */
+   while (k > 1 && isRed(path[k - 1]))
+   {
+      Node* node = path[k];
+      Node* parent = path[k - 1];
+      Node* grand = path[k - 2];
+      bool parentLeft = grand->left == parent;
+      Node* uncle = parentLeft ? grand->right : grand->left;
+      if (isRed(uncle))
+      {
+         parent->bal = RedBlackBalance::BLACK;
+         uncle->bal = RedBlackBalance::BLACK;
+         grand->bal = RedBlackBalance::RED;
+         k -= 2;
+         continue;
+      }
+      if (parentLeft && parent->right == node)
+      {
+         grand->left = rotateLeft(parent);
+         parent = node;
+      }
+      else if (!parentLeft && parent->left == node)
+      {
+         grand->right = rotateRight(parent);
+         parent = node;
+      }
+      Node* subRoot = parentLeft ? rotateRight(grand) : rotateLeft(grand);
+      subRoot->bal = RedBlackBalance::BLACK;
+      grand->bal = RedBlackBalance::RED;
+      relink(k > 2 ? path[k - 3] : NULL, grand, subRoot);
+      path[k - 2] = subRoot;
+      length = k - 1;
+      break;
+   }
+   root->bal = RedBlackBalance::BLACK;
+   return length;
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::rebalanceRemove(Node** path, int length, const Node* removed, bool fromLeft, WAVLBalance)
+{
+   int k = length - 1;
+   Node* node = removed->left != NULL ? removed->left : removed->right;
+   /* a leaf of rank 1 left behind is a 2,2-leaf: demote it */
+   if (k >= 0 && path[k]->left == NULL && path[k]->right == NULL && path[k]->bal == 1)
+   {
+      path[k]->bal = 0;
+      node = path[k];
+      k--;
+      if (k >= 0)
+         fromLeft = path[k]->left == node;
+   }
+   /* climb while the node is a 3-child */
+   while (k >= 0 && path[k]->bal - rankOf(node) == 3)
+   {
+      Node* parent = path[k];
+      Node* sibling = fromLeft ? parent->right : parent->left;
+      if (parent->bal - sibling->bal == 2)
+         parent->bal--;
+      else if (sibling->bal - rankOf(sibling->left) == 2 && sibling->bal - rankOf(sibling->right) == 2)
+      {
+         parent->bal--;
+         sibling->bal--;
+      }
+      else
+      {
+         Node* outer = fromLeft ? sibling->right : sibling->left;
+         Node* subRoot;
+         if (sibling->bal - rankOf(outer) == 1)
+         {
+            subRoot = fromLeft ? rotateLeft(parent) : rotateRight(parent);
+            sibling->bal++;
+            parent->bal--;
+            if (parent->left == NULL && parent->right == NULL)
+               parent->bal--;
+         }
+         else
+         {
+            Node* inner = fromLeft ? sibling->left : sibling->right;
+            if (fromLeft)
+            {
+               parent->right = rotateRight(sibling);
+               subRoot = rotateLeft(parent);
+            }
+            else
+            {
+               parent->left = rotateLeft(sibling);
+               subRoot = rotateRight(parent);
+            }
+            inner->bal += 2;
+            sibling->bal--;
+            parent->bal -= 2;
+         }
+         relink(k > 0 ? path[k - 1] : NULL, parent, subRoot);
+         return;
+      }
+      node = parent;
+      k--;
+      if (k >= 0)
+         fromLeft = path[k]->left == node;
+   }
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::rebalanceRemove(Node** path, int length, const Node* removed, bool fromLeft, RedBlackBalance)
+{
+   Node* node = removed->left != NULL ? removed->left : removed->right;
+   if (isRed(removed))
+      return;
+   if (isRed(node))
+   {
+      node->bal = RedBlackBalance::BLACK;
+      return;
+   }
+   /* node is doubly black: take a black from a sibling or pass it up */
+   int k = length - 1;
+   while (k >= 0)
+   {
+      Node* parent = path[k];
+      Node* sibling = fromLeft ? parent->right : parent->left;
+      if (isRed(sibling))
+      {
+         /* rotate the red sibling up; the parent moves down a level */
+         Node* subRoot = fromLeft ? rotateLeft(parent) : rotateRight(parent);
+         sibling->bal = RedBlackBalance::BLACK;
+         parent->bal = RedBlackBalance::RED;
+         relink(k > 0 ? path[k - 1] : NULL, parent, subRoot);
+         path[k] = subRoot;
+         path[++k] = parent;
+         continue;
+      }
+      Node* outer = fromLeft ? sibling->right : sibling->left;
+      Node* inner = fromLeft ? sibling->left : sibling->right;
+      if (!isRed(outer) && !isRed(inner))
+      {
+         sibling->bal = RedBlackBalance::RED;
+         if (isRed(parent))
+         {
+            parent->bal = RedBlackBalance::BLACK;
+            return;
+         }
+         node = parent;
+         k--;
+         if (k >= 0)
+            fromLeft = path[k]->left == node;
+         continue;
+      }
+      if (!isRed(outer))
+      {
+         if (fromLeft)
+            parent->right = rotateRight(sibling);
+         else
+            parent->left = rotateLeft(sibling);
+         inner->bal = RedBlackBalance::BLACK;
+         sibling->bal = RedBlackBalance::RED;
+         outer = sibling;
+         sibling = inner;
+      }
+      Node* subRoot = fromLeft ? rotateLeft(parent) : rotateRight(parent);
+      sibling->bal = parent->bal;
+      parent->bal = RedBlackBalance::BLACK;
+      outer->bal = RedBlackBalance::BLACK;
+      relink(k > 0 ? path[k - 1] : NULL, parent, subRoot);
+      return;
+   }
+}
+
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::relink(Node* parent, Node* child, Node* sub)
+{
+   if (parent == NULL)
+      root = sub;
+   else if (parent->left == child)
+      parent->left = sub;
+   else
+      parent->right = sub;
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::rankOf(const Node* node)
+{
+   return node == NULL ? -1 : node->bal;
+}
+
+template <typename E, typename Aug, typename Bal>
+bool AVLTree<E,Aug,Bal>::isRed(const Node* node)
+{
+   return node != NULL && node->bal == RedBlackBalance::RED;
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::settle(Node*, int depth, int deepest, AVLBalance)
+{
+   return deepest - depth;
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::settle(Node* node, int depth, int deepest, WAVLBalance)
+{
+   if (node == NULL)
+      return -1;
+   int leftHeight = settle(node->left, depth + 1, deepest, WAVLBalance());
+   int rightHeight = settle(node->right, depth + 1, deepest, WAVLBalance());
+   node->bal = max(leftHeight, rightHeight) + 1;
+   return node->bal;
+}
+
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::settle(Node* node, int depth, int deepest, RedBlackBalance)
+{
+   if (node == NULL)
+      return -1;
+   int leftHeight = settle(node->left, depth + 1, deepest, RedBlackBalance());
+   int rightHeight = settle(node->right, depth + 1, deepest, RedBlackBalance());
+   node->bal = depth == deepest && depth > 0 ? RedBlackBalance::RED : RedBlackBalance::BLACK;
+   return max(leftHeight, rightHeight) + 1;
+}
+
+template <typename E, typename Aug, typename Bal>
+template<typename Probe>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::remove(Node* node, const Probe& probe, bool& shorter, bool& success)
 {
    Node* delPtr;   
    Node* exchPtr;
@@ -580,27 +2234,49 @@ typename AVLTree<E>::Node* AVLTree<E>::remove(Node* node,const E& key, bool& sho
       success = false;
       return NULL;
    }
-   if (cmp(key,node->data) < 0)
+   int diff = probe(node);
+   if (diff < 0)
    {
-      node->left = remove(node->left,key,shorter,success);
+      node->left = remove(node->left,probe,shorter,success);
       if (shorter)
          node = deleteRightBalance(node,shorter);
    }
-   else if (cmp(key,node->data) > 0)
+   else if (diff > 0)
    {
-      node->right = remove(node->right,key,shorter,success);
+      node->right = remove(node->right,probe,shorter,success);
       if (shorter)
          node = deleteLeftBalance(node,shorter);
    }
    else
    {
       delPtr = node;
+      if (node->mult == 0)
+      {
+         /* a tombstone: the key is not in the tree */
+         success = false;
+         shorter = false;
+         return node;
+      }
+      if (node->mult > 1 || lazyThreshold > 0)
+      {
+         node->mult--;
+         if (node->mult == 0)
+         {
+            nodeCount--;
+            deadCount++;
+         }
+         refresh(node);
+         success = true;
+         shorter = false;
+         return node;
+      }
       if (node->right == NULL)
       {
          newRoot = node->left;
          success = true;
          shorter = true;
-         delete delPtr;
+         freeNode(delPtr);
+         nodeCount--;
          return newRoot;
       }
       if(node->left == NULL)
@@ -608,7 +2284,8 @@ typename AVLTree<E>::Node* AVLTree<E>::remove(Node* node,const E& key, bool& sho
          newRoot = node->right;
          success = true;
          shorter = true;
-         delete delPtr;
+         freeNode(delPtr);
+         nodeCount--;
          return newRoot;
       }
       else
@@ -616,18 +2293,21 @@ typename AVLTree<E>::Node* AVLTree<E>::remove(Node* node,const E& key, bool& sho
          exchPtr = node->left;
          while(exchPtr->right != NULL)
             exchPtr = exchPtr->right;
-         node->data = exchPtr->data;
-         node->left = remove(node->left,exchPtr->data,shorter,success);
+         setData(node, exchPtr->data);
+         node->mult = exchPtr->mult;
+         exchPtr->mult = 1;
+         node->left = remove(node->left,RightmostProbe(),shorter,success);
          if (shorter)
             node = deleteRightBalance(node,shorter);
       }
    }
+   refresh(node);
    return node;
 }
 
 
-template<typename E>
-typename AVLTree<E>::Node* AVLTree<E>::deleteRightBalance(Node* node,bool& shorter)
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::deleteRightBalance(Node* node,bool& shorter)
 {
    Node* rightTree;
    Node* leftTree;
@@ -686,8 +2366,8 @@ typename AVLTree<E>::Node* AVLTree<E>::deleteRightBalance(Node* node,bool& short
    return node;
 }
 
-template<typename E>
-typename AVLTree<E>::Node* AVLTree<E>::deleteLeftBalance(Node* node,bool& shorter)
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Node* AVLTree<E,Aug,Bal>::deleteLeftBalance(Node* node,bool& shorter)
 {
    Node* rightTree;
    Node* leftTree;
@@ -747,70 +2427,130 @@ typename AVLTree<E>::Node* AVLTree<E>::deleteLeftBalance(Node* node,bool& shorte
 }
 /* BEGIN: Augmented Private Auxiliary Functions */
 
-template<typename E>
-int AVLTree<E>::height(Node* node) const
-{
-   if(node == nullptr)
-   {
-       return -1;
-   }
-   int leftHeight = height(node->left);
-   int rightHeight = height(node->right);
-   return max(leftHeight, rightHeight) + 1;    
-}
-
-template <typename E>
-void AVLTree<E>::preorderTraverse (Node* node, FuncType func)
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::preorderTraverse (Node* node, FuncType func)
 {
     if (node)
     {
-        func(node->data);
+        if (node->mult > 0)
+            func(node->data);
         preorderTraverse(node->left, func);
         preorderTraverse(node->right, func);
     }
 }
-template <typename E>
-void AVLTree<E>::postorderTraverse (Node* node, FuncType func)
+template <typename E, typename Aug, typename Bal>
+void AVLTree<E,Aug,Bal>::postorderTraverse (Node* node, FuncType func)
 {
     if (node)
     {
         postorderTraverse(node->left, func);
         postorderTraverse(node->right, func);
-        func(node->data);
+        if (node->mult > 0)
+            func(node->data);
     }
 }
 
-template<typename E>
-int AVLTree<E>::countDesc(Node* node) const
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Shape AVLTree<E,Aug,Bal>::shapeOf() const
 {
-   if (node == nullptr) 
-    {
-        return 0; // Base case: empty subtree has no descendants
-    }
-    int leftDescendants = countDesc(node->left);
-    int rightDescendants = countDesc(node->right);
-    
-    int totalDescendants = leftDescendants + rightDescendants;
-    
-    if (node->left != nullptr && node->right != nullptr)
-    {
-        totalDescendants += 2;
-    }
-    
-    else if (node->left != nullptr || node->right != nullptr)
-    {
-        totalDescendants += 1;
-    }
-    return totalDescendants;
+   std::lock_guard<std::mutex> guard(shapeLock);
+   if (shapeVersion != version)
+   {
+      shape = measure(Bal());
+      shapeVersion = version;
+   }
+   return shape;
+}
+
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Shape AVLTree<E,Aug,Bal>::measure(AVLBalance) const
+{
+   /* the weights count nodes only when every node holds one occurrence */
+   if (multiset || deadCount > 0)
+      return walkShape();
+   Shape result;
+   result.height = heightOf(root);
+   result.leftHeight = root ? heightOf(root->left) : -1;
+   result.rightHeight = root ? heightOf(root->right) : -1;
+   result.complete = true;
+   const Node* node = root;
+   int nodeHeight = result.height;
+   /* a complete tree is a perfect left subtree beside a complete right
+      one of the same height, or a complete left subtree beside a perfect
+      right one a level shorter; only the complete side needs a descent */
+   while (node && weightOf(node) != (1LL << (nodeHeight + 1)) - 1)
+   {
+      int leftHeight = heightOf(node->left);
+      int rightHeight = heightOf(node->right);
+      if (leftHeight == rightHeight && weightOf(node->left) == (1LL << (leftHeight + 1)) - 1)
+      {
+         node = node->right;
+         nodeHeight = rightHeight;
+      }
+      else if (leftHeight == rightHeight + 1 && weightOf(node->right) == (1LL << (rightHeight + 1)) - 1)
+      {
+         node = node->left;
+         nodeHeight = leftHeight;
+      }
+      else
+      {
+         result.complete = false;
+         break;
+      }
+   }
+   return result;
+}
+
+template <typename E, typename Aug, typename Bal>
+template <typename Policy>
+typename AVLTree<E,Aug,Bal>::Shape AVLTree<E,Aug,Bal>::measure(Policy) const
+{
+   return walkShape();
+}
+
+template <typename E, typename Aug, typename Bal>
+typename AVLTree<E,Aug,Bal>::Shape AVLTree<E,Aug,Bal>::walkShape() const
+{
+   Shape result;
+   if (root == NULL)
+   {
+      result.height = result.leftHeight = result.rightHeight = -1;
+      result.complete = true;
+      return result;
+   }
+   bool leftPerfect;
+   bool leftComplete;
+   bool rightPerfect;
+   bool rightComplete;
+   result.leftHeight = measure(root->left, leftPerfect, leftComplete);
+   result.rightHeight = measure(root->right, rightPerfect, rightComplete);
+   result.height = max(result.leftHeight, result.rightHeight) + 1;
+   result.complete = (leftPerfect && rightComplete && result.leftHeight == result.rightHeight)
+      || (leftComplete && rightPerfect && result.leftHeight == result.rightHeight + 1);
+   return result;
 }
 
-template<typename E>  
-bool AVLTree<E>::isComplete(Node* node, int index) const
+template <typename E, typename Aug, typename Bal>
+int AVLTree<E,Aug,Bal>::measure(const Node* node, bool& perfect, bool& complete)
 {
-    //Implement this function
-    if (node == nullptr) return true;
-    if (index >= size()) return false;
-    return isComplete(node->left,2*index+1) && isComplete(node->right,2*index+2);
+   if (node == NULL)
+   {
+      perfect = true;
+      complete = true;
+      return -1;
+   }
+   bool leftPerfect;
+   bool leftComplete;
+   bool rightPerfect;
+   bool rightComplete;
+   int leftHeight = measure(node->left, leftPerfect, leftComplete);
+   int rightHeight = measure(node->right, rightPerfect, rightComplete);
+   perfect = leftPerfect && rightPerfect && leftHeight == rightHeight;
+   complete = (leftPerfect && rightComplete && leftHeight == rightHeight)
+      || (leftComplete && rightPerfect && leftHeight == rightHeight + 1);
+   return max(leftHeight, rightHeight) + 1;
 }
 /* END: Augmented Private Auxiliary Functions */ 
 
+//AVLTREE_CPP
+#endif
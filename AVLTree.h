@@ -11,6 +11,9 @@
  */
 
 #include <string>
+#include <cstring>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <cassert>
 #include <stdexcept>
@@ -19,6 +22,25 @@
 #include <vector>
 #include <cstdlib>
 #include <functional>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <new>
+#include <type_traits>
+#include <limits>
+#include <atomic>
+#include <memory>
+#include <string_view>
+#include <exception>
+#include <utility>
+#include "CountingBloomFilter.h"
+#include "AVLWorkPool.h"
+#include "KeyNormalizer.h"
+#include "StringArena.h"
+#include "NodePool.h"
+#include "AVLReclaimer.h"
 
 #ifndef AVLTREE_H
 #define AVLTREE_H
@@ -56,10 +78,328 @@ public:
    }
 };
 
+/**
+ * A breakdown of the memory used by an AVL tree
+ * @see AVLTree::memoryUsage
+ */
+struct AVLMemoryUsage
+{
+   /**
+    * the number of nodes in the tree
+    */
+   size_t nodes;
+   /**
+    * the bytes occupied by the node structures themselves
+    */
+   size_t nodeBytes;
+   /**
+    * the heap bytes owned by the keys outside of their nodes
+    */
+   size_t keyBytes;
+   /**
+    * the bytes lost to the allocator: block headers and size-class
+    * rounding of the node and key allocations
+    */
+   size_t allocatorBytes;
+   /**
+    * Gives the total number of bytes used by the tree
+    * @return the sum of the node, key and allocator bytes
+    */
+   size_t total() const
+   {
+      return nodeBytes + keyBytes + allocatorBytes;
+   }
+};
+
+/**
+ * The hit rate of the hot-key cache of an AVL tree
+ * @see AVLTree::useCache
+ */
+struct AVLCacheStats
+{
+   /**
+    * the number of slots in the cache; 0 when it is off
+    */
+   size_t slots;
+   /**
+    * the lookups answered from the cache
+    */
+   unsigned long hits;
+   /**
+    * the lookups that descended the tree
+    */
+   unsigned long misses;
+   /**
+    * the slots cleared because their node was freed or given another key
+    */
+   unsigned long invalidations;
+   /**
+    * Gives the fraction of lookups answered from the cache
+    * @return the hits over all lookups; 0 before the first lookup
+    */
+   double hitRate() const
+   {
+      return hits + misses == 0 ? 0 : (double)hits / (hits + misses);
+   }
+};
+
+/**
+ * Gives the number of heap bytes that an element owns outside of its
+ * own storage. Elements that own no heap memory report 0.
+ * @param item an element
+ * @return the out-of-line heap bytes owned by the element
+ */
+template <typename E>
+inline size_t keyHeapBytes(const E&)
+{
+   return 0;
+}
+
+/**
+ * Gives the number of heap bytes that a string owns; strings short enough
+ * to be kept in the small-string buffer own none.
+ * @param item a string
+ * @return the size of the heap buffer of this string
+ */
+inline size_t keyHeapBytes(const string& item)
+{
+   static const size_t inlineCapacity = string().capacity();
+   return item.capacity() > inlineCapacity ? item.capacity() + 1 : 0;
+}
+
+/**
+ * Compares two elements by their < and == operators; the order of a tree
+ * constructed without a comparator
+ * @param a an element
+ * @param b another element
+ * @return a negative integer when a precedes b; 0 when they are equal;
+ * otherwise, a positive integer
+ */
+template <typename E>
+inline int naturalOrder(const E& a, const E& b)
+{
+   return a < b? -1 : (a == b? 0 : 1);
+}
+
+/**
+ * Gives the number of heap bytes that a normalized key owns
+ * @param item a normalized key
+ * @return the sizes of the heap buffers of its encoding and text
+ */
+inline size_t keyHeapBytes(const NormalizedKey& item)
+{
+   return keyHeapBytes(item.bytes) + keyHeapBytes(item.text);
+}
+
+/**
+ * Gives the value that aggregate policies summarize for an element: the
+ * element itself, or the mapped value of a key-value pair.
+ * @param item an element
+ * @return the value of the element to be aggregated
+ */
+template <typename E>
+inline const E& aggregateValue(const E& item)
+{
+   return item;
+}
+
+/**
+ * Gives the value that aggregate policies summarize for a key-value pair
+ * @param item a key-value pair
+ * @return the value of the pair
+ */
+template <typename K, typename V>
+inline const V& aggregateValue(const pair<K,V>& item)
+{
+   return item.second;
+}
+
+/**
+ * The default augmentation policy: nodes keep no summary of their subtree.
+ * An augmentation policy is a monoid: it supplies a value_type, an
+ * identity, the value of a single element and an associative combine.
+ * Each node keeps the combined value of its subtree in in-order, kept
+ * current through every rotation and on the way back up insertions and
+ * deletions.
+ */
+struct NoAugment
+{
+   struct value_type
+   {
+   };
+
+   static value_type identity()
+   {
+      return value_type();
+   }
+
+   template <typename E>
+   static value_type of(const E&)
+   {
+      return value_type();
+   }
+
+   static value_type combine(const value_type& a, const value_type&)
+   {
+      return a;
+   }
+};
+
+/**
+ * Augments a tree of closed intervals, stored as pair<T,T> of low and
+ * high endpoints and ordered by low endpoint, with the maximum high
+ * endpoint in each subtree; this turns the tree into an interval tree.
+ * @param <T> the endpoint type
+ * @see AVLTree::overlapping
+ */
+template <typename T>
+struct IntervalAugment
+{
+   typedef T value_type;
+
+   static value_type identity()
+   {
+      return numeric_limits<T>::lowest();
+   }
+
+   static value_type of(const pair<T,T>& interval)
+   {
+      return interval.second;
+   }
+
+   static value_type combine(const value_type& a, const value_type& b)
+   {
+      return a < b ? b : a;
+   }
+};
+
+/**
+ * Sums the values of the elements in each subtree
+ * @param <T> the type of the sum
+ * @see aggregateValue
+ */
+template <typename T>
+struct SumAggregate
+{
+   typedef T value_type;
+
+   static value_type identity()
+   {
+      return T();
+   }
+
+   template <typename E>
+   static value_type of(const E& item)
+   {
+      return aggregateValue(item);
+   }
+
+   static value_type combine(const value_type& a, const value_type& b)
+   {
+      return a + b;
+   }
+};
+
+/**
+ * Keeps the minimum of the values of the elements in each subtree
+ * @param <T> the value type
+ * @see aggregateValue
+ */
+template <typename T>
+struct MinAggregate
+{
+   typedef T value_type;
+
+   static value_type identity()
+   {
+      return numeric_limits<T>::max();
+   }
+
+   template <typename E>
+   static value_type of(const E& item)
+   {
+      return aggregateValue(item);
+   }
+
+   static value_type combine(const value_type& a, const value_type& b)
+   {
+      return b < a ? b : a;
+   }
+};
+
+/**
+ * Keeps the maximum of the values of the elements in each subtree
+ * @param <T> the value type
+ * @see aggregateValue
+ */
+template <typename T>
+struct MaxAggregate
+{
+   typedef T value_type;
+
+   static value_type identity()
+   {
+      return numeric_limits<T>::lowest();
+   }
+
+   template <typename E>
+   static value_type of(const E& item)
+   {
+      return aggregateValue(item);
+   }
+
+   static value_type combine(const value_type& a, const value_type& b)
+   {
+      return a < b ? b : a;
+   }
+};
+
+/**
+ * The default balancing policy: each node keeps its AVL balance factor,
+ * so a tree of n nodes is never taller than 1.44 log n, but a deletion
+ * may rotate at every level on the way back up. A balancing policy names
+ * the balance information a node keeps, LEAF being that of a new leaf;
+ * the tree applies the policy's rules on the way back up insertions and
+ * deletions.
+ * @see WAVLBalance
+ * @see RedBlackBalance
+ */
+struct AVLBalance
+{
+   static const int LEAF = 0;
+};
+
+/**
+ * Weak AVL balancing: each node keeps a rank that exceeds the ranks of
+ * its children by 1 or 2, leaves having rank 0. Without deletions the
+ * tree is an AVL tree; a deletion performs at most two rotations and the
+ * height stays under 2 log n.
+ */
+struct WAVLBalance
+{
+   static const int LEAF = 0;
+};
+
+/**
+ * Red-black balancing: each node keeps a color. An insertion performs at
+ * most two rotations and a deletion at most three, and the height stays
+ * under 2 log n.
+ */
+struct RedBlackBalance
+{
+   static const int RED = 0;
+   static const int BLACK = 1;
+   static const int LEAF = RED;
+};
+
+template <typename K, typename V>
+class AVLMap;
 
 /**
  * Describes operations on an AVLTree
  * @param <E> the data type
+ * @param <Aug> the augmentation policy
+ * @param <Bal> the balancing policy
  * @author William Duncan
  * @see AVLTreeException
  * <pre>
@@ -85,7 +425,7 @@ public:
  * along with this program.  If not, see <https://www.gnu.org/licenses/>
  * </pre>
  */
-template <typename E>
+template <typename E, typename Aug = NoAugment, typename Bal = AVLBalance>
 class AVLTree
 {
 private:  
@@ -95,10 +435,12 @@ private:
     {
     public:
        /**
-          Constructs a node with a given data value.
-          @param s the data to store in this node
+          Constructs a node whose data is built in place from the given
+          arguments.
+          @param args the arguments of the data's constructor
        */
-       Node(E s);
+       template <typename... Args>
+       explicit Node(Args&&... args);
     private:
        /**
         * the data in this node
@@ -113,133 +455,756 @@ private:
         */
        Node * right;
        /**
-        * the balanced factor of this node
+        * the balance information of this node under the balancing policy:
+        * its balance factor, rank or color
         */
-       BalancedFactor bal;
-      friend class AVLTree<E>;
+       int bal;
+       /**
+        * the number of occurrences of the data in this node
+        */
+       int mult;
+       /**
+        * the number of occurrences in the subtree rooted at this node
+        */
+       int weight;
+       /**
+        * the augmentation value of the subtree rooted at this node
+        */
+       typename Aug::value_type agg;
+      friend class AVLTree<E,Aug,Bal>;
+      template <typename K, typename V>
+      friend class AVLMap;
     }; 
+
+    /**
+     * the deepest path a cursor can record; the height of an AVL tree
+     * of 2^31 nodes is at most 45
+     */
+    static const int MAX_DEPTH = 64;
+public:
+    /**
+     * A finger into a tree: the root-to-node path of a position, used as
+     * a hint to start searches near it. A cursor returned by locate also
+     * answers genealogy queries about the item it found in O(1) each. A
+     * cursor goes stale when its tree is modified through any other
+     * cursor or operation.
+     */
+    class Cursor
+    {
+    public:
+       /**
+        * Constructs a cursor that refers to no position
+        */
+       Cursor();
+
+       /**
+        * Determines whether this cursor is at an item of a tree that has
+        * not been modified since
+        * @return true if the accessors of this cursor can be used;
+        * otherwise, false
+        */
+       bool isValid() const;
+
+       /**
+        * Gives the item at this cursor
+        * @return the item
+        * @throws AVLTreeException when this cursor is not valid
+        */
+       const E& data() const;
+
+       /**
+        * Gives the item in the parent node of this cursor's node
+        * @return a pointer to the parent's item or null at the root
+        * @throws AVLTreeException when this cursor is not valid
+        */
+       const E* parent() const;
+
+       /**
+        * Gives the item in the left child of this cursor's node
+        * @return a pointer to the left child's item or null if there is none
+        * @throws AVLTreeException when this cursor is not valid
+        */
+       const E* left() const;
+
+       /**
+        * Gives the item in the right child of this cursor's node
+        * @return a pointer to the right child's item or null if there is none
+        * @throws AVLTreeException when this cursor is not valid
+        */
+       const E* right() const;
+
+       /**
+        * Gives the depth of this cursor's node: its number of ancestors
+        * @return the number of nodes above this cursor's node
+        * @throws AVLTreeException when this cursor is not valid
+        */
+       int depth() const;
+
+       /**
+        * Gives the number of items in the subtree of this cursor's node,
+        * counting each occurrence in a multiset
+        * @return the weight of this cursor's subtree
+        * @throws AVLTreeException when this cursor is not valid
+        */
+       int subtreeSize() const;
+
+       /**
+        * Gives the number of items below this cursor's node
+        * @return the size of the subtree less the item at this cursor
+        * @throws AVLTreeException when this cursor is not valid
+        */
+       int descendants() const;
+    private:
+       /**
+        * Gives the node at this cursor
+        * @return the last node of the path
+        * @throws AVLTreeException when this cursor is not valid
+        */
+       const Node* node() const;
+       /**
+        * the tree this cursor refers to
+        */
+       const AVLTree<E,Aug,Bal>* owner;
+       /**
+        * the version of the tree this path was recorded at
+        */
+       unsigned long version;
+       /**
+        * the nodes from the root to the position
+        */
+       Node* path[MAX_DEPTH];
+       /**
+        * the number of nodes in the path
+        */
+       int length;
+       /**
+        * whether the path ends at the item that was searched for
+        */
+       bool matched;
+      friend class AVLTree<E,Aug,Bal>;
+    };
+private:
+    /**
+     * An auxiliary function that frees the memory allocated for the
+     * nodes of a subtree. It flattens the subtree with right rotations as
+     * it goes, so it uses constant stack space; when the nodes come from
+     * a pool, only their data is destroyed and the chunks are released
+     * in bulk.
+     * @param subtreeRoot a root of this subtree
+     * @param nodePool the pool the nodes were allocated from or null
+     */
+    static void destroy(Node* subtreeRoot, NodePool* nodePool);
+   /**
+    * Finds the node that matches a probe or inserts a new node where it
+    * belongs, in a single descent. The search starts at the deepest node
+    * of the cursor's path whose subtree spans the key, so a key close to
+    * the previous position costs O(log d) comparisons for distance d;
+    * the cursor is moved to the found or inserted node.
+    * @param at the cursor to start from; a stale cursor starts at the root
+    * @param probe compares the search key with a node: negative when the
+    * key precedes the node's data, 0 when they match, otherwise positive
+    * @param hit updates the matching node when there is one
+    * @param miss allocates the node to be inserted when there is no match
+    * @return the matching or the inserted node
+    */
+    template <typename Probe, typename Hit, typename Miss>
+    Node* findOrInsert(Cursor& at, const Probe& probe, const Hit& hit, const Miss& miss);
+
+   /**
+    * Finds the node that matches a probe or inserts a new one, starting
+    * from the position of the last insertion
+    * @param probe compares the search key with a node
+    * @param hit updates the matching node when there is one
+    * @param miss allocates the node to be inserted when there is no match
+    * @return the matching or the inserted node
+    */
+    template <typename Probe, typename Hit, typename Miss>
+    Node* findOrInsert(const Probe& probe, const Hit& hit, const Miss& miss);
+
+   /**
+    * Gives the number of leading nodes of a cursor's path to keep when
+    * searching for a key: the path down to the deepest node whose
+    * subtree spans the key. Each bound on the way up is compared once.
+    * @param at a current cursor
+    * @param probe compares the search key with a node
+    * @return the length of the usable prefix of the path
+    */
+    template <typename Probe>
+    int reach(const Cursor& at, const Probe& probe) const;
+
+   /**
+    * An auxiliary method that left-balances the specified node
+    * @param curRoot the node to be left-balanced
+    * @param taller indicates whether the tree becomes taller
+    * @return the root of the subtree after left-balancing
+    */    
+    Node* leftBalance(Node* curRoot, bool& taller);
+    
+   /**
+    * An auxiliary method that right-balances the specified node
+    * @param curRoot the node to be right-balanced
+    * @param taller indicates whether the tree becomes taller
+    * @return the root of the subtree after right-balancing
+    */       
+    Node* rightBalance(Node* curRoot, bool& taller);
+
+   /**
+    * Restores the AVL balance factors along the path to a new leaf
+    * @param path the nodes from the root to the new leaf
+    * @param length the number of nodes in the path
+    * @return the length of the path down to the root of the subtree that
+    * holds the new leaf after any rotation
+    */
+    int rebalanceInsert(Node** path, int length, AVLBalance);
+
+   /**
+    * Restores the WAVL ranks along the path to a new leaf by promotions
+    * and at most one single or double rotation
+    * @param path the nodes from the root to the new leaf
+    * @param length the number of nodes in the path
+    * @return the length of the path down to the root of the subtree that
+    * holds the new leaf after any rotation
+    */
+    int rebalanceInsert(Node** path, int length, WAVLBalance);
+
+   /**
+    * Restores the red-black colors along the path to a new red leaf by
+    * recoloring and at most one single or double rotation
+    * @param path the nodes from the root to the new leaf
+    * @param length the number of nodes in the path
+    * @return the length of the path down to the root of the subtree that
+    * holds the new leaf after any rotation
+    */
+    int rebalanceInsert(Node** path, int length, RedBlackBalance);
+
+   /**
+    * Restores the WAVL ranks after a node has been unlinked, by demotions
+    * and at most one single or double rotation
+    * @param path the ancestors of the unlinked node, from the root
+    * @param length the number of ancestors
+    * @param removed the unlinked node
+    * @param fromLeft indicates whether it was the left child of its parent
+    */
+    void rebalanceRemove(Node** path, int length, const Node* removed, bool fromLeft, WAVLBalance);
+
+   /**
+    * Restores the red-black colors after a node has been unlinked, by
+    * recoloring and at most three rotations
+    * @param path the ancestors of the unlinked node, from the root
+    * @param length the number of ancestors
+    * @param removed the unlinked node
+    * @param fromLeft indicates whether it was the left child of its parent
+    */
+    void rebalanceRemove(Node** path, int length, const Node* removed, bool fromLeft, RedBlackBalance);
+
+   /**
+    * Replaces a child of a node, or the root, with another subtree
+    * @param parent the parent of the child; null for the root
+    * @param child the subtree to be replaced
+    * @param sub the replacement subtree
+    */
+    void relink(Node* parent, Node* child, Node* sub);
+
+   /**
+    * Gives the WAVL rank of a node
+    * @param node a node or null
+    * @return the rank of the node; -1 when it is null
+    */
+    static int rankOf(const Node* node);
+
+   /**
+    * Determines whether a node is red; null nodes are black
+    * @param node a node or null
+    * @return true when the node is red; otherwise, false
+    */
+    static bool isRed(const Node* node);
+
+   /**
+    * Sets the balance information of a subtree built by buildBalanced;
+    * the AVL balance factors are already set
+    * @param node the root of the subtree
+    * @param depth the depth of the subtree
+    * @param deepest the depth of the deepest level of the tree
+    * @return the height of the subtree
+    */
+    static int settle(Node* node, int depth, int deepest, AVLBalance);
+
+   /**
+    * Sets the ranks of a subtree built by buildBalanced to the heights
+    * of its nodes
+    * @param node the root of the subtree
+    * @param depth the depth of the subtree
+    * @param deepest the depth of the deepest level of the tree
+    * @return the height of the subtree
+    */
+    static int settle(Node* node, int depth, int deepest, WAVLBalance);
+
+   /**
+    * Colors a subtree built by buildBalanced: the nodes on the deepest
+    * level of an incomplete tree red and the others black
+    * @param node the root of the subtree
+    * @param depth the depth of the subtree
+    * @param deepest the depth of the deepest level of the tree
+    * @return the height of the subtree
+    */
+    static int settle(Node* node, int depth, int deepest, RedBlackBalance);
+   /**
+    * An auxiliary method that Left-rotates the subtree at this node
+    * @param node the node at which the left-rotation occurs.
+    * @return the new node of the subtree after the left-rotation
+    */    
+    Node* rotateLeft(Node* node);
+    
+   /**
+    * An auxiliary method that right-rotates the subtree at this node
+    * @param node the node at which the right-rotation occurs.
+    * @return the new node of the subtree after the right-rotation
+    */    
+    Node* rotateRight(Node* node);
+    
+   /**
+    * An auxiliary method that in-order traverses the subtree at the specified node
+    * @param node the root of a subtree
+    * @param func the function to be applied to the data in each node
+    */    
+    void traverse (Node* node, FuncType func);
+
+   /**
+    * Matches the rightmost node of a subtree; used to unlink the in-order
+    * predecessor of a node with two children without any comparisons
+    */
+    struct RightmostProbe
+    {
+       int operator()(const Node* node) const
+       {
+          return node->right != NULL ? 1 : 0;
+       }
+    };
+
+   /**
+    * Matches the node of the least live key, steering by the occurrence
+    * weights around lazily deleted nodes; no keys are compared
+    */
+    struct FirstLiveProbe
+    {
+       int operator()(const Node* node) const
+       {
+          if (weightOf(node->left) > 0)
+             return -1;
+          return node->mult > 0 ? 0 : 1;
+       }
+    };
+
+   /**
+    * Matches the node of the greatest live key without comparing keys
+    */
+    struct LastLiveProbe
+    {
+       int operator()(const Node* node) const
+       {
+          if (weightOf(node->right) > 0)
+             return 1;
+          return node->mult > 0 ? 0 : -1;
+       }
+    };
+
+   /**
+    * Follows a probe down from the root
+    * @param probe compares the search key with a node
+    * @return the node the probe matches; NULL when there is none
+    */
+    template <typename Probe>
+    Node* seek(const Probe& probe) const;
+
+   /**
+    * Finds the nodes of the least and greatest live keys again if this
+    * tree has changed since they were last found
+    */
+    void findExtremes() const;
+
+   /**
+    * An auxiliary method that deletes the node matching a probe from a subtree
+    * @param node the root of a subtree
+    * @param probe compares the search key with a node
+    * @param shorter indicates whether the subtree becomes shorter
+    * @param success indicates whether an item was removed, whether by
+    * unlinking its node, dropping one of its copies or leaving a tombstone
+    * @return the root of the subtree after the deletion
+    */    
+    template <typename Probe>
+    Node* remove(Node* node, const Probe& probe, bool& shorter, bool& success);
+
+   /**
+    * Removes one copy of the item matching a probe from this tree; its
+    * node is unlinked once no copies remain, unless lazy deletion keeps it
+    * as a tombstone
+    * @param probe compares the search key with a node
+    * @return true when an item was removed; otherwise, false
+    */
+    template <typename Probe>
+    bool removeMatching(const Probe& probe);
+
+   /**
+    * Deletes the node matching a probe from this AVL tree recursively
+    * @param probe compares the search key with a node
+    * @return true when an item was removed; otherwise, false
+    */
+    template <typename Probe>
+    bool removeMatching(const Probe& probe, AVLBalance);
+
+   /**
+    * Deletes the node matching a probe along a recorded path and hands the
+    * path to the policy's rebalanceRemove
+    * @param probe compares the search key with a node
+    * @return true when an item was removed; otherwise, false
+    */
+    template <typename Probe, typename Policy>
+    bool removeMatching(const Probe& probe, Policy);
+   /**
+    * An auxiliary method that right-balances this subtree after a deletion
+    * @param node the node to be right-balanced
+    * @param shorter indicates whether the subtree becomes shorter
+    * @return a reference to the root of the subtree after right-balancing.
+    */    
+    Node* deleteRightBalance(Node* node, bool& shorter);
+   /**
+    * An auxiliary method that left-balances this subtree after a deletion
+    * @param node the node to be left-balanced
+    * @param shorter indicates whether the subtree becomes shorter
+    * @return a reference to the root of the subtree after left-balancing.
+    */       
+    Node* deleteLeftBalance(Node* node, bool& shorter);
+    
+    /**
+     * Traverses this subtree preorder and apply the specified
+     * function to the entry in each node
+     * @param node the root of the subtree
+     * @param func the function to apply to the entry in each node
+     */
+    void preorderTraverse (Node* node, FuncType func);
+    
+    /**
+     * Traverses this subtree postorder and apply the specified
+     * function to the entry in each node
+     * @param node the root of the subtree
+     * @param func the function to apply to the entry in each node
+     */
+    void postorderTraverse (Node* node, FuncType func);    
+    
+    /**
+     * An auxiliary function that iteratively computes a fibonacci number
+     * @param n the position of the term in the fibonacci sequence
+     * @return the nth fibonacci number or -1 if n < -1
+     */
+    static int fibonacci(int n);
+    
+    /**
+     * The tree-wide properties reported by height(), diameter(),
+     * isFibonacci() and isComplete()
+     */
+    struct Shape
+    {
+       /**
+        * the height of the tree
+        */
+       int height;
+       /**
+        * the heights of the subtrees of the root
+        */
+       int leftHeight;
+       int rightHeight;
+       /**
+        * whether every level is full but the last, which is filled from the left
+        */
+       bool complete;
+    };
+
+    /**
+     * Gives the shape of this tree, measuring it again only when the tree
+     * has been modified since it was last measured. The cache is guarded
+     * by shapeLock, so threads only reading the tree may call this at once.
+     * @return the shape of this tree
+     */
+    Shape shapeOf() const;
+
+    /**
+     * Measures an AVL tree in O(log^2 n) time: the heights follow the
+     * balance factors and a subtree is perfect when its weight is
+     * 2^(h+1) - 1; falls back to walkShape when the weights do not count
+     * the nodes
+     * @return the shape of this tree
+     */
+    Shape measure(AVLBalance) const;
+
+    /**
+     * Measures a tree whose balance information does not give heights
+     * @return the shape of this tree
+     */
+    template <typename Policy>
+    Shape measure(Policy) const;
+
+    /**
+     * Measures this tree in one postorder pass
+     * @return the shape of this tree
+     */
+    Shape walkShape() const;
+
+    /**
+     * Measures the subtree rooted at the specified node
+     * @param node the root of a subtree
+     * @param perfect set to whether every level of the subtree is full
+     * @param complete set to whether the subtree is complete
+     * @return the height of the subtree
+     */
+    static int measure(const Node* node, bool& perfect, bool& complete);
+
+    /**
+     * Recursively copies the subtree rooted at the specified node,
+     * forking the copy of the left subtree onto another thread for the
+     * specified number of levels.
+     * @param node the root of the subtree to be copied
+     * @param forks the number of levels at which to copy concurrently
+     * @param bytes accumulates the heap bytes of the copied keys
+     * @param slack accumulates the allocator overhead of the copied keys
+     * @return the root of the copy
+     */
+    static Node* cloneSubtree(const Node* node, int forks, size_t& bytes, size_t& slack);
+
+    /**
+     * Applies a function to the data of a subtree, forking the left
+     * subtree of every node whose subtree weighs more than the grain
+     * @param node the root of a subtree
+     * @param func the function to apply
+     * @param grain the weight of the largest subtree visited sequentially
+     * @param group the group the forked tasks join
+     */
+    static void forEachIn(const Node* node, const FuncType& func, int grain, AVLWorkPool::Group& group);
+
+    /**
+     * Copies the data of a subtree in order into a slice of an array; a
+     * node's position follows from the weight of its left subtree, so
+     * the two subtrees of a heavy node are copied concurrently
+     * @param node the root of a subtree
+     * @param out the start of the slice of the subtree
+     * @param grain the weight of the largest subtree copied sequentially
+     * @param group the group the forked tasks join
+     */
+    static void exportSubtree(const Node* node, E* out, int grain, AVLWorkPool::Group& group);
+
+    /**
+     * the minimum size of a tree that clone() copies concurrently
+     */
+    static const int PARALLEL_CLONE_SIZE = 1 << 16;
+
+    /**
+     * Recursively collects the intervals that overlap a query interval
+     * @param node the root of a subtree
+     * @param lo the low endpoint of the query interval
+     * @param hi the high endpoint of the query interval
+     * @param found the overlapping intervals, in order
+     */
+    template <typename T>
+    static void overlapping(const Node* node, const T& lo, const T& hi, vector<E>& found);
+
+    /**
+     * Recomputes the occurrence weight and augmentation value of the
+     * specified node from its children; called whenever the children of
+     * a node change
+     * @param node a node in this tree
+     */
+    static void refresh(Node* node);
+
+    /**
+     * Gives the augmentation value of the data in the specified node,
+     * combined once for each of its occurrences by repeated doubling;
+     * lazily deleted nodes contribute the policy's identity
+     * @param node a node in this tree
+     * @return the value of this node's data under the augmentation policy
+     */
+    static typename Aug::value_type valueOf(const Node* node);
+
+    /**
+     * Links a sorted run of nodes into a perfectly balanced subtree
+     * @param nodes the nodes in order
+     * @param first the index of the first node of the run
+     * @param last the index one past the last node of the run
+     * @param height set to the height of the subtree
+     * @return the root of the subtree
+     */
+    static Node* buildBalanced(const vector<Node*>& nodes, size_t first, size_t last, int& height);
+
+    /**
+     * Gives the height of a subtree by following its balance factors down
+     * the taller side, in O(log n) time
+     * @param node the root of a subtree or null
+     * @return the height of the subtree; -1 when it is empty
+     */
+    static int heightOf(const Node* node);
+
+    /**
+     * Joins two subtrees and a node that falls between them into one
+     * balanced subtree, in time proportional to the difference of their
+     * heights
+     * @param left a subtree whose keys all precede the middle node
+     * @param mid the node to join; its children are overwritten
+     * @param right a subtree whose keys all follow the middle node
+     * @return the root of the joined subtree
+     */
+    Node* join(Node* left, Node* mid, Node* right);
+
+    /**
+     * An auxiliary method of join that descends the right spine of the
+     * taller left subtree and rebalances on the way back up
+     * @param node the root of a subtree of the left tree
+     * @param nodeHeight the height of this subtree
+     * @param mid the node to join
+     * @param right the right tree
+     * @param rightHeight the height of the right tree
+     * @param taller indicates whether the subtree becomes taller
+     * @return the root of the subtree after the join
+     */
+    Node* joinRight(Node* node, int nodeHeight, Node* mid, Node* right, int rightHeight, bool& taller);
+
+    /**
+     * An auxiliary method of join that descends the left spine of the
+     * taller right subtree and rebalances on the way back up
+     * @param left the left tree
+     * @param leftHeight the height of the left tree
+     * @param mid the node to join
+     * @param node the root of a subtree of the right tree
+     * @param nodeHeight the height of this subtree
+     * @param taller indicates whether the subtree becomes taller
+     * @return the root of the subtree after the join
+     */
+    Node* joinLeft(Node* left, int leftHeight, Node* mid, Node* node, int nodeHeight, bool& taller);
+
+    /**
+     * Joins two subtrees whose keys are in order into one balanced subtree
+     * @param left a subtree whose keys all precede those of the right one
+     * @param right a subtree
+     * @return the root of the joined subtree
+     */
+    Node* concat(Node* left, Node* right);
+
+    /**
+     * Unlinks the leftmost node of a subtree without freeing it
+     * @param node the root of a non-empty subtree
+     * @param min set to the unlinked node
+     * @param shorter indicates whether the subtree becomes shorter
+     * @return the root of the subtree after the unlinking
+     */
+    Node* detachMin(Node* node, Node*& min, bool& shorter);
+
+    /**
+     * Splits a subtree into the nodes that satisfy a predicate and the
+     * nodes that do not; the predicate must hold for a prefix of the
+     * subtree in order
+     * @param node the root of a subtree
+     * @param before the predicate that selects the nodes of the left part
+     * @param left set to the root of the nodes satisfying the predicate
+     * @param right set to the root of the other nodes
+     */
+    template <typename Before>
+    void split(Node* node, const Before& before, Node*& left, Node*& right);
+
+    /**
+     * Frees every node of a detached subtree in constant stack space
+     * @param node the root of the subtree
+     * @param live accumulates the number of live nodes freed
+     * @param dead accumulates the number of dead nodes freed
+     */
+    void freeSubtree(Node* node, int& live, int& dead);
+
     /**
-     * An auxiliary function that recursively free the memory
-     * allocated for the nodes of this tree.
-     * @param subtreeRoot a root of this subtree
+     * Removes the run of nodes between two split points with two splits
+     * and one join
+     * @param below selects the nodes that precede the run
+     * @param through selects the nodes that precede the run or are in it
+     * @return the number of keys removed
      */
-    void recDestroy(Node* subtreeRoot);
-   /**
-    * An auxiliary method that inserts a new node in the tree or
-    * updates a node if the data is already in the tree.
-    * @param curRoot a root of a subtree
-    * @param newNode the new node to be inserted
-    * @param taller indicates whether the subtree becomes
-    * taller after the insertion
-    * @return a reference to the new node
-    */
-    Node* insert(Node* curRoot, Node* newNode, bool& taller);
+    template <typename Below, typename Through>
+    int eraseBetween(const Below& below, const Through& through, AVLBalance);
 
-   /**
-    * An auxiliary method that left-balances the specified node
-    * @param curRoot the node to be left-balanced
-    * @param taller indicates whether the tree becomes taller
-    * @return the root of the subtree after left-balancing
-    */    
-    Node* leftBalance(Node* curRoot, bool& taller);
-    
-   /**
-    * An auxiliary method that right-balances the specified node
-    * @param curRoot the node to be right-balanced
-    * @param taller indicates whether the tree becomes taller
-    * @return the root of the subtree after right-balancing
-    */       
-    Node* rightBalance(Node* curRoot, bool& taller);
-   /**
-    * An auxiliary method that Left-rotates the subtree at this node
-    * @param node the node at which the left-rotation occurs.
-    * @return the new node of the subtree after the left-rotation
-    */    
-    Node* rotateLeft(Node* node);
-    
-   /**
-    * An auxiliary method that right-rotates the subtree at this node
-    * @param node the node at which the right-rotation occurs.
-    * @return the new node of the subtree after the right-rotation
-    */    
-    Node* rotateRight(Node* node);
-    
-   /**
-    * An auxiliary method that in-order traverses the subtree at the specified node
-    * @param node the root of a subtree
-    * @param func the function to be applied to the data in each node
-    */    
-    void traverse (Node* node, FuncType func);
+    /**
+     * Removes the run of nodes between two split points by rebuilding the
+     * tree from the nodes outside it; the split and join of an AVL tree
+     * rely on its balance factors
+     * @param below selects the nodes that precede the run
+     * @param through selects the nodes that precede the run or are in it
+     * @return the number of keys removed
+     */
+    template <typename Below, typename Through, typename Policy>
+    int eraseBetween(const Below& below, const Through& through, Policy);
 
-   /**
-    * An auxiliary method that deletes the specified node from this tree
-    * @param node the node to be deleted
-    * @param key the item stored in this node
-    * @param shorter indicates whether the subtree becomes shorter
-    * @param success indicates whether the node was successfully deleted
-    * @return a reference to the deleted node
-    */    
-    Node* remove(Node* node,const E& key, bool& shorter, bool& success);
-   /**
-    * An auxiliary method that right-balances this subtree after a deletion
-    * @param node the node to be right-balanced
-    * @param shorter indicates whether the subtree becomes shorter
-    * @return a reference to the root of the subtree after right-balancing.
-    */    
-    Node* deleteRightBalance(Node* node, bool& shorter);
-   /**
-    * An auxiliary method that left-balances this subtree after a deletion
-    * @param node the node to be left-balanced
-    * @param shorter indicates whether the subtree becomes shorter
-    * @return a reference to the root of the subtree after left-balancing.
-    */       
-    Node* deleteLeftBalance(Node* node, bool& shorter);
-    
     /**
-     * Determines the height of the subtree rooted at the specified node
-     * @param node a root of the subtree
-     * @return the height of the tree rooted at the specified node
+     * Gives the occurrence weight of the subtree rooted at the specified node
+     * @param node the root of a subtree or null
+     * @return the number of occurrences in this subtree
      */
-    int height(Node* node) const;
+    static int weightOf(const Node* node);
 
     /**
-     * Traverses this subtree preorder and apply the specified
-     * function to the entry in each node
-     * @param node the root of the subtree
-     * @param func the function to apply to the entry in each node
+     * Allocates a node, building its data in place, and accounts for
+     * its memory
+     * @param args the arguments of the data's constructor
+     * @return a pointer to the new node
      */
-    void preorderTraverse (Node* node, FuncType func);
-    
+    template <typename... Args>
+    Node* newNode(Args&&... args);
+
     /**
-     * Traverses this subtree postorder and apply the specified
-     * function to the entry in each node
-     * @param node the root of the subtree
-     * @param func the function to apply to the entry in each node
+     * Releases the memory of the specified node and its accounting
+     * @param node the node to be freed
      */
-    void postorderTraverse (Node* node, FuncType func);    
-    
+    void freeNode(Node* node);
+
     /**
-     * Recursively counts the number of descendants that the specified node has.
-     * @param node the root of a subtree
-     * @return the number of descendants of the specified node
+     * Replaces the data in the specified node, keeping the key memory
+     * accounting up to date
+     * @param node a node in this tree
+     * @param item the new data for this node
      */
-    int countDesc(Node* node) const; 
-    
+    void setData(Node* node, const E& item);
+
     /**
-     * An auxiliary function that iteratively computes a fibonacci number
-     * @param n the position of the term in the fibonacci sequence
-     * @return the nth fibonacci number or -1 if n < -1
+     * Finds the node holding a key, through the hot-key cache when it is
+     * on, and caches the node found
+     * @param item the search key
+     * @return the node whose key equals the search key, live or lazily
+     * deleted; NULL when there is none
      */
-    static int fibonacci(int n);
-    
+    Node* search(const E& item) const;
+
     /**
-     * Determines whether the tree rooted at the specified node is complete 
-     * @param node the root of a subtree
-     * @param index the level-order index of the specified Node
-     * @return true if the subtree rooted at the specified node is complete; 
-     * otherwise, false
+     * Clears the hot-key cache slot of a node that is about to be freed
+     * or given another key
+     * @param node a node of this tree
+     */
+    void forget(const Node* node);
+
+    /**
+     * Empties every slot of the hot-key cache
      */
-    bool isComplete(Node* node, int index) const;   
+    void forgetAll();
+
+    /**
+     * Gives the hash the Bloom filter files a key under
+     * @param item a key
+     * @return the hash of the key
+     */
+    size_t filterKey(const E& item) const
+    {
+       return filterHash ? filterHash(item) : keyHash(item);
+    }
+
+    /**
+     * Replaces the Bloom filter with one sized for a number of keys and
+     * counts the keys of every node in it
+     * @param expectedKeys the number of keys to size the filter for
+     * @param falsePositiveRate the false-positive rate to size it for
+     * @param maxBytes the most bytes the counters may take; 0 for no limit
+     */
+    void refilter(size_t expectedKeys, double falsePositiveRate, size_t maxBytes);
     
     /**
      * the root of this tree
@@ -248,7 +1213,128 @@ private:
     /**
      * the size of this tree
      */
-    int count;   
+    int nodeCount;   
+    /**
+     * the pool this tree allocates its nodes from or null when each node
+     * is allocated individually
+     */
+    NodePool* pool;
+    /**
+     * whether duplicate insertions are counted rather than replacing
+     * the data in the node
+     */
+    bool multiset;
+    /**
+     * the fraction of dead nodes that triggers a purge, or 0 when
+     * deletions unlink nodes immediately
+     */
+    double lazyThreshold;
+    /**
+     * the number of lazily deleted nodes still linked into this tree
+     */
+    int deadCount;
+    /**
+     * counts structural modifications so that stale cursors are detected
+     */
+    unsigned long version;
+    /**
+     * the shape of this tree when it was last measured
+     */
+    mutable Shape shape;
+    /**
+     * the version of this tree the shape was measured at
+     */
+    mutable unsigned long shapeVersion;
+    /**
+     * guards shape and shapeVersion
+     */
+    mutable std::mutex shapeLock;
+    /**
+     * the nodes of the least and greatest live keys, or NULL when this
+     * tree holds no live keys; kept across insertions and pops, found
+     * again after any other change. findExtremes() stores them before
+     * publishing extremesVersion with release order, so const readers on
+     * several threads see either the old version or both nodes.
+     */
+    mutable atomic<Node*> lowest;
+    mutable atomic<Node*> highest;
+    /**
+     * the version of this tree the extreme nodes were found at
+     */
+    mutable atomic<unsigned long> extremesVersion;
+    /**
+     * the path to the most recently inserted node
+     */
+    Cursor finger;
+    /**
+     * the heap bytes owned by the keys in the nodes of this tree
+     */
+    size_t keyBytes;
+    /**
+     * the estimated allocator overhead of the key buffers
+     */
+    size_t keySlack;
+    /**
+     * A slot of the hot-key cache
+     */
+    struct HotSlot
+    {
+       /**
+        * a node whose key hashes to this slot, or NULL
+        */
+       atomic<Node*> node;
+       /**
+        * set when the node is found here; a miss that would replace the
+        * node clears it instead, so a node must go unused for a whole
+        * round of misses before it is replaced
+        */
+       atomic<bool> referenced;
+
+       HotSlot(Node* cached, bool recent) : node(cached), referenced(recent)
+       {
+       }
+
+       HotSlot(const HotSlot& other)
+          : node(other.node.load(memory_order_relaxed)),
+            referenced(other.referenced.load(memory_order_relaxed))
+       {
+       }
+
+       HotSlot& operator=(const HotSlot& other)
+       {
+          node.store(other.node.load(memory_order_relaxed), memory_order_relaxed);
+          referenced.store(other.referenced.load(memory_order_relaxed), memory_order_relaxed);
+          return *this;
+       }
+    };
+    /**
+     * the hot-key cache: slot i holds a node whose key hashes to i, modulo
+     * the number of slots; empty when the cache is off. Lookups update the
+     * slots and the counts below with relaxed atomic operations, so
+     * concurrent lookups may race to fill a slot but never tear one.
+     */
+    mutable vector<HotSlot> hotKeys;
+    /**
+     * the lookups answered from the hot-key cache
+     */
+    mutable atomic<unsigned long> hotHits;
+    /**
+     * the lookups that missed the hot-key cache
+     */
+    mutable atomic<unsigned long> hotMisses;
+    /**
+     * the hot-key cache slots cleared by changes to the tree
+     */
+    unsigned long hotInvalidations;
+    /**
+     * the Bloom filter counting the keys of the nodes of this tree, lazily
+     * deleted ones included, or null when there is none
+     */
+    CountingBloomFilter* filter;
+    /**
+     * the hash the filter files keys under; keyHash() when null
+     */
+    std::function<size_t(const E&)> filterHash;
    /**
     * A trichotomous integer-value comparator lambda function; that is,
     * it compares two elements of this AVL tree and returns a negative
@@ -256,7 +1342,27 @@ private:
     * otherwise, a positive integer
     * 
     */
-   std::function<int(E,E)> cmp = nullptr;     
+   std::function<int(const E&, const E&)> cmp = nullptr;     
+   /**
+    * indicates whether the elements are ordered by naturalOrder(), which
+    * is then called directly, and inlined, in place of the comparator
+    */
+   bool natural;
+
+   /**
+    * Compares two elements in the order of this tree
+    * @param a an element
+    * @param b another element
+    * @return a negative integer when a precedes b; 0 when they are equal;
+    * otherwise, a positive integer
+    */
+   int order(const E& a, const E& b) const
+   {
+      return natural ? naturalOrder(a, b) : cmp(a, b);
+   }
+
+   template <typename K, typename V>
+   friend class AVLMap;
 public:
    /**
     * Constructs an empty AVL tree;
@@ -267,12 +1373,238 @@ public:
     * A parameterized constructor    
     * @param fn - an integer-value binary comparator function   
     */
-   AVLTree(std::function<int(E,E)> fn);   
+   AVLTree(std::function<int(const E&, const E&)> fn);   
+   
+   /**
+    * Trees are not copied implicitly; use clone() for a deep copy.
+    */
+   AVLTree(const AVLTree<E,Aug,Bal>& other) = delete;
+
+   /**
+    * Move constructor - takes over the nodes and the order of the
+    * specified tree in constant time, leaving it empty and ordered by
+    * naturalOrder()
+    * @param other the tree whose nodes are taken
+    */
+   AVLTree(AVLTree<E,Aug,Bal>&& other) noexcept;
+
+   /**
+    * Trees are not copied implicitly; use clone() for a deep copy.
+    */
+   AVLTree<E,Aug,Bal>& operator=(const AVLTree<E,Aug,Bal>& other) = delete;
+
+   /**
+    * Move assignment - frees the nodes of this tree and takes over the
+    * nodes and the order of the specified tree in constant time, leaving
+    * it empty and ordered as this tree was
+    * @param other the tree whose nodes are taken
+    * @return this tree
+    */
+   AVLTree<E,Aug,Bal>& operator=(AVLTree<E,Aug,Bal>&& other) noexcept;
    
    /**
     * destructor - returns the AVL tree memory to the system;
     */
    ~AVLTree();
+
+   /**
+    * Makes this tree allocate its nodes from a pool of fixed-size chunks
+    * @param nodesPerChunk the number of nodes in each chunk
+    * @throws AVLTreeException when this tree is not empty
+    */
+   void usePool(size_t nodesPerChunk = 4096);
+
+   /**
+    * Turns multiset mode on or off. In multiset mode each node counts the
+    * occurrences of its key: inserting an existing key increments its
+    * count and removing it decrements the count, unlinking the node only
+    * when the count reaches zero.
+    * @param enable true to count duplicates; false to replace them
+    * @throws AVLTreeException when this tree is not empty
+    */
+   void setMultiset(bool enable);
+
+   /**
+    * Puts a hot-key cache in front of lookups: a direct-mapped table of
+    * nodes indexed by the hash of their keys. inTree() and retrieve()
+    * check the slot of the search key first and return its node at once
+    * when its key equals the search key; otherwise they descend the tree
+    * and cache the node they find, unless the node in its slot has been
+    * found since the last miss there, as in CLOCK. Slots are cleared when their node is
+    * freed or its key replaced, including by the predecessor swap of a
+    * deletion; rotations move nodes but not keys, so they leave the
+    * cache as it is. Lookups write the cache with relaxed atomic
+    * operations, so a tree with a cache may still be searched by several
+    * threads at once, provided none of them changes it.
+    * @param slots the number of slots, rounded up to a power of two; 0
+    * turns the cache off
+    */
+   void useCache(size_t slots);
+
+   /**
+    * Gives the hit rate of the hot-key cache since it was turned on
+    * @return the size, hits, misses and invalidations of the cache
+    */
+   AVLCacheStats cacheStats() const;
+
+   /**
+    * Puts a counting Bloom filter in front of lookups. Every key put into
+    * a node is counted in the filter and uncounted when its node is freed
+    * or given another key, so inTree() and retrieve() answer a key whose
+    * counters are not all set without descending the tree. The filter
+    * grows, rebuilt from the nodes, when it holds more keys than it was
+    * sized for, as long as it stays within its budget. A filter must hash
+    * equal keys alike: the elements' std::hash serves under the natural
+    * order; a tree with a comparator needs a hash consistent with it.
+    * @param expectedKeys the number of keys to size the filter for; 0
+    * turns the filter off
+    * @param falsePositiveRate the fraction of lookups of absent keys to
+    * let through at that load
+    * @param maxBytes the most bytes the filter may take, at the cost of
+    * its false-positive rate; 0 for no limit
+    * @param hash a hash that is equal for keys the comparator finds equal;
+    * null to use std::hash
+    * @throws AVLTreeException when this tree has a comparator and no hash
+    * is given
+    */
+   void useFilter(size_t expectedKeys, double falsePositiveRate = 0.01, size_t maxBytes = 0,
+                  std::function<size_t(const E&)> hash = nullptr);
+
+   /**
+    * Gives the state and effectiveness of the Bloom filter
+    * @return the size, load, rejections and false positives of the
+    * filter; all 0 when it is off
+    */
+   AVLFilterStats filterStats() const;
+
+   /**
+    * Turns lazy deletion on or off. With lazy deletion, removing a key
+    * only marks its node dead: lookups and traversals skip dead nodes,
+    * and re-inserting the key revives the node in place. Once dead nodes
+    * make up more than the threshold fraction of the tree, they are
+    * purged in a single linear-time rebuild.
+    * @param threshold the dead fraction in (0, 1] that triggers a purge;
+    * 0 to unlink nodes on every removal
+    * @throws AVLTreeException when this tree is not empty
+    */
+   void setLazyDelete(double threshold);
+
+   /**
+    * Frees the nodes left dead by lazy deletions and rebuilds this tree
+    * perfectly balanced in linear time
+    */
+   void purge();
+
+   /**
+    * Removes every key in the closed range [lo, hi]. The range is split
+    * out of the tree, the remaining parts are joined with a single
+    * rebalancing pass, and the detached nodes are freed together, so the
+    * cost is O(log n + k) for k removed nodes.
+    * @param lo the lower bound of the range
+    * @param hi the upper bound of the range
+    * @return the number of keys removed
+    */
+   int eraseRange(const E& lo, const E& hi);
+
+   /**
+    * Removes every key that precedes the specified key
+    * @param key the watermark, which is kept if it is in this tree
+    * @return the number of keys removed
+    * @see eraseRange
+    */
+   int truncateBelow(const E& key);
+
+   /**
+    * Removes every key that follows the specified key
+    * @param key the watermark, which is kept if it is in this tree
+    * @return the number of keys removed
+    * @see eraseRange
+    */
+   int truncateAbove(const E& key);
+
+   /**
+    * Gives the number of occurrences of the specified key
+    * @param key the search key
+    * @return the multiplicity of the key; 0 when it is not in this tree
+    */
+   int count(const E& key) const;
+
+   /**
+    * Gives the number of occurrences in this tree, counting duplicates;
+    * equal to size() unless this tree is a multiset
+    * @return the total multiplicity of the keys in this tree
+    */
+   int occurrences() const;
+
+   /**
+    * Gives the item with the specified rank, counting duplicates
+    * @param k a rank in the range [0, occurrences())
+    * @return the item such that exactly k occurrences precede it
+    * @throws AVLTreeException when k is out of range
+    */
+   const E& select(int k) const;
+
+   /**
+    * Counts the occurrences that precede the specified key, counting duplicates
+    * @param key a search key, which need not be in this tree
+    * @return the number of occurrences less than the key
+    */
+   int rank(const E& key) const;
+
+   /**
+    * Combines the values of the elements in the closed range [lo, hi]
+    * under the augmentation policy, in order, along two root-to-leaf
+    * paths; in a multiset each occurrence of an element counts.
+    * @param lo the lower bound of the range
+    * @param hi the upper bound of the range
+    * @return the combined value of the elements in the range; the
+    * policy's identity when the range is empty
+    */
+   typename Aug::value_type aggregate(const E& lo, const E& hi) const;
+
+   /**
+    * Gives the combined value of all the elements of this tree
+    * @return the augmentation value of the root; the policy's identity
+    * when this tree is empty
+    */
+   typename Aug::value_type aggregate() const;
+
+   /**
+    * Finds the intervals that overlap the closed interval [lo, hi]. This
+    * tree must hold pair<T,T> intervals ordered by low endpoint and be
+    * augmented with IntervalAugment<T>; subtrees whose maximum high
+    * endpoint is below lo, and right subtrees of nodes whose low endpoint
+    * is above hi, are skipped.
+    * @param lo the low endpoint of the query interval
+    * @param hi the high endpoint of the query interval
+    * @return the overlapping intervals in order of low endpoint
+    */
+   template <typename T>
+   vector<E> overlapping(const T& lo, const T& hi) const;
+
+   /**
+    * Finds the intervals that contain the specified point
+    * @param point a point
+    * @return the intervals containing the point in order of low endpoint
+    * @see overlapping
+    */
+   template <typename T>
+   vector<E> stabbing(const T& point) const;
+
+   /**
+    * Empties this tree in constant time. The detached nodes are freed on
+    * a background thread.
+    */
+   void clear();
+
+   /**
+    * Makes a deep copy of this tree. The copy has the same shape and
+    * balance factors as this tree, so it is built in linear time without
+    * comparisons or rotations; the subtrees of large trees are copied
+    * concurrently. The nodes of the copy are allocated individually.
+    * @return a tree with the same comparator and a copy of each node
+    */
+   AVLTree<E,Aug,Bal> clone() const;
        
    /**
     * Determines whether the tree is empty.
@@ -286,6 +1618,26 @@ public:
    */
    void insert(const E& obj);
 
+   /**
+      Inserts an item into the tree, searching from a hint rather than
+      from the root; inserting a sorted or nearly sorted stream by
+      passing back each returned cursor costs O(log d) comparisons per
+      item for a distance d from the previous item. insert(obj) does the
+      same from the position of the last insertion.
+      @param hint a cursor returned by an earlier insertion
+      @param obj the value to be inserted.
+      @return a cursor at the inserted item
+   */
+   Cursor insert(const Cursor& hint, const E& obj);
+
+   /**
+    * Finds an item in a single descent and records the path to it
+    * @param item item with a specified search key.
+    * @return a cursor at the item; it is not valid when the item is not
+    * in the tree
+    */
+   Cursor locate(const E& item) const;
+
    /**
     * Determine whether an item is in the tree.
     * @param item item with a specified search key.
@@ -307,6 +1659,38 @@ public:
     */
    const E& retrieve(const E& key) const;
 
+   /**
+    * Gives the least item in the tree, in constant time while the tree
+    * changes only by insertions and pops
+    * @return the least item
+    * @throws AVLTreeException when the tree is empty
+    */
+   const E& findMin() const;
+
+   /**
+    * Gives the greatest item in the tree, in constant time while the tree
+    * changes only by insertions and pops
+    * @return the greatest item
+    * @throws AVLTreeException when the tree is empty
+    */
+   const E& findMax() const;
+
+   /**
+    * Removes one occurrence of the least item in the tree; the node is
+    * found without comparing keys and has no left child, so it is
+    * unlinked directly
+    * @return the item removed
+    * @throws AVLTreeException when the tree is empty
+    */
+   E popMin();
+
+   /**
+    * Removes one occurrence of the greatest item in the tree
+    * @return the item removed
+    * @throws AVLTreeException when the tree is empty
+    */
+   E popMax();
+
    /**
     * This function traverses the tree in in-order
     * and calls the function Visit once for each node.
@@ -314,6 +1698,27 @@ public:
     */
    void traverse(FuncType func);
 
+   /**
+    * Applies a function to each item of the tree on the threads of the
+    * work-stealing pool; the items are visited in no particular order and
+    * the function must be safe to call concurrently. The tree must not be
+    * modified until this returns.
+    * @param func the function to apply to each item
+    * @param grain the number of items below which a subtree is visited
+    * by a single thread
+    */
+   void parallelForEach(FuncType func, int grain = 4096) const;
+
+   /**
+    * Copies the items of the tree into a vector in order, filling
+    * disjoint slices of it concurrently. In a multiset each occurrence
+    * is copied.
+    * @param grain the number of items below which a subtree is copied
+    * by a single thread
+    * @return the items of the tree in order
+    */
+   vector<E> toVector(int grain = 4096) const;
+
    /**
     * Returns the number of nodes in this tree. 
     * @return the size of this tree.
@@ -382,11 +1787,7 @@ public:
     * @param entry an entry in this tree
     * @return the number of descendants for the specified entry
     * @throw AVLTreeException if this entry is not in this tree
-	* <pre>
-	* This function sets a pointer to the node containing the entry and 
-	* passes that pointer to the countDesc function to recursively
-	* count the descendants of the node containing that enry.
-	* </pre>
+    * @see Cursor::descendants
     */
    int descendants(E entry) const;
 
@@ -401,6 +1802,14 @@ public:
     * @return true if this tree is complete; otherwise, false
     */
    bool isComplete() const;
+
+   /**
+    * Gives a breakdown of the memory used by this tree. The figures come
+    * from counters maintained on every insertion and deletion, so no
+    * traversal is performed.
+    * @return the node, key and allocator bytes used by this tree
+    */
+   AVLMemoryUsage memoryUsage() const;
  
 
 };
@@ -0,0 +1,141 @@
+/**
+ * Models a work-stealing thread pool.
+ * @author William Duncan, Cody Carter
+ * @see AVLWorkPool
+ * <pre>
+ * Date: 10/18/2023
+ * </pre>
+ */
+#ifndef AVLWORKPOOL_CPP
+#define AVLWORKPOOL_CPP
+
+#include "AVLWorkPool.h"
+
+using namespace std;
+
+inline AVLWorkPool::Group::Group() : pending(0)
+{
+}
+
+inline void AVLWorkPool::Group::fork(std::function<void()> task)
+{
+   pending++;
+   AVLWorkPool::instance().submit([this, task]()
+      {
+         try
+         {
+            task();
+         }
+         catch (...)
+         {
+            std::lock_guard<std::mutex> guard(lock);
+            if (!failure)
+               failure = std::current_exception();
+         }
+         pending--;
+      });
+}
+
+inline void AVLWorkPool::Group::join()
+{
+   while (pending > 0)
+      if (!AVLWorkPool::instance().runOne())
+         std::this_thread::yield();
+   if (failure)
+      std::rethrow_exception(failure);
+}
+
+inline AVLWorkPool::~AVLWorkPool()
+{
+   {
+      std::lock_guard<std::mutex> guard(idleLock);
+      stopping = true;
+   }
+   idle.notify_all();
+   for (size_t i = 0; i < threads.size(); i++)
+      threads[i].join();
+}
+
+inline AVLWorkPool& AVLWorkPool::instance()
+{
+   static AVLWorkPool pool;
+   return pool;
+}
+
+inline int AVLWorkPool::concurrency() const
+{
+   return threads.size() + 1;
+}
+
+inline void AVLWorkPool::submit(std::function<void()> task)
+{
+   Worker& own = *workers[self()];
+   {
+      std::lock_guard<std::mutex> guard(own.lock);
+      own.tasks.push_back(std::move(task));
+   }
+   queued++;
+   if (!threads.empty())
+   {
+      std::lock_guard<std::mutex> guard(idleLock);
+      idle.notify_one();
+   }
+}
+
+inline bool AVLWorkPool::runOne()
+{
+   std::function<void()> task;
+   int home = self();
+   for (size_t k = 0; k < workers.size() && !task; k++)
+   {
+      Worker& victim = *workers[(home + k) % workers.size()];
+      std::lock_guard<std::mutex> guard(victim.lock);
+      if (victim.tasks.empty())
+         continue;
+      if (k == 0)
+      {
+         task = std::move(victim.tasks.back());
+         victim.tasks.pop_back();
+      }
+      else
+      {
+         task = std::move(victim.tasks.front());
+         victim.tasks.pop_front();
+      }
+   }
+   if (!task)
+      return false;
+   queued--;
+   task();
+   return true;
+}
+
+/* Private functions */
+
+inline int& AVLWorkPool::self()
+{
+   thread_local int index = 0;
+   return index;
+}
+
+inline AVLWorkPool::AVLWorkPool() : queued(0), stopping(false)
+{
+   unsigned cores = std::thread::hardware_concurrency();
+   unsigned count = cores > 1 ? cores - 1 : 0;
+   for (unsigned i = 0; i <= count; i++)
+      workers.push_back(unique_ptr<Worker>(new Worker()));
+   for (unsigned i = 1; i <= count; i++)
+      threads.push_back(std::thread([this, i]()
+         {
+            self() = i;
+            while (!stopping)
+               if (!runOne())
+               {
+                  std::unique_lock<std::mutex> guard(idleLock);
+                  idle.wait(guard, [this]() { return stopping || queued > 0; });
+               }
+         }));
+}
+
+//AVLWORKPOOL_CPP
+#endif
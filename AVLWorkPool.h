@@ -0,0 +1,147 @@
+/**
+ * Models a work-stealing thread pool
+ * @author William Duncan, Cody Carter
+ * <pre>
+ * File: AVLWorkPool.h
+ * Date: 10/18/2023
+ * </pre>
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef AVLWORKPOOL_H
+#define AVLWORKPOOL_H
+
+using namespace std;
+
+/**
+ * A process-wide work-stealing pool for fork-join work over subtrees.
+ * Each worker owns a deque of tasks: it runs its newest task first and,
+ * when its deque is empty, steals the oldest task of another worker,
+ * which tends to be the largest subtree left. A thread waiting for a
+ * group runs queued tasks instead of blocking, so nested forks cannot
+ * deadlock and the waiting thread adds to the parallelism.
+ */
+class AVLWorkPool
+{
+private:
+   /**
+    * A worker's task deque
+    */
+   struct alignas(64) Worker
+   {
+      deque<std::function<void()>> tasks;
+      std::mutex lock;
+   };
+   /**
+    * the task deques; one per pool thread and one shared by the other threads
+    */
+   vector<unique_ptr<Worker>> workers;
+   /**
+    * the pool threads
+    */
+   vector<std::thread> threads;
+   /**
+    * the number of queued tasks
+    */
+   std::atomic<int> queued;
+   /**
+    * whether the pool threads should exit
+    */
+   std::atomic<bool> stopping;
+   /**
+    * guards the sleep of idle pool threads
+    */
+   std::mutex idleLock;
+   /**
+    * signals idle pool threads that a task was queued
+    */
+   std::condition_variable idle;
+
+   /**
+    * Gives the deque owned by the calling thread
+    * @return the index of the calling thread's deque; the shared one for
+    * threads outside the pool
+    */
+   static int& self();
+
+   /**
+    * Starts one pool thread for each core but the caller's
+    */
+   AVLWorkPool();
+public:
+   /**
+    * Tracks a set of forked tasks so that their parent can wait for them
+    */
+   class Group
+   {
+   private:
+      /**
+       * the number of unfinished tasks
+       */
+      std::atomic<int> pending;
+      /**
+       * the first exception thrown by a task
+       */
+      std::exception_ptr failure;
+      /**
+       * guards the failure
+       */
+      std::mutex lock;
+   public:
+      Group();
+
+      /**
+       * Queues a task on the pool
+       * @param task the task to run
+       */
+      void fork(std::function<void()> task);
+
+      /**
+       * Runs queued tasks until every task of this group has finished
+       * @throws the first exception thrown by a task of this group
+       */
+      void join();
+   };
+
+   /**
+    * destructor - stops the pool threads once they finish their tasks
+    */
+   ~AVLWorkPool();
+
+   /**
+    * Gives the process-wide pool
+    * @return the pool shared by all trees
+    */
+   static AVLWorkPool& instance();
+
+   /**
+    * Gives the number of threads that run tasks, the caller included
+    * @return the number of pool threads plus one
+    */
+   int concurrency() const;
+
+   /**
+    * Queues a task on the calling thread's deque
+    * @param task the task to run
+    */
+   void submit(std::function<void()> task);
+
+   /**
+    * Runs the newest task of the calling thread's deque or, failing
+    * that, the oldest task of another deque
+    * @return true when a task was run; false when every deque was empty
+    */
+   bool runOne();
+};
+
+//AVLWORKPOOL_H
+#endif
@@ -0,0 +1,421 @@
+/**
+ * Models an ordered set on a B+-tree of fat nodes.
+ * @param <E> data type of the tree
+ * @author William Duncan, Cody Carter
+ * @see BPlusTree
+ * <pre>
+ * Date: 10/18/2023
+ * </pre>
+ */
+#ifndef BPLUSTREE_CPP
+#define BPLUSTREE_CPP
+
+#include "BPlusTree.h"
+#include "AVLTree.cpp"
+
+using namespace std;
+
+template <typename E>
+BPlusTree<E>::BPlusTree() : BPlusTree([](const E& a, const E& b) -> int{return a < b? -1 : (b < a? 1 : 0);})
+{
+   natural = true;
+}
+
+template <typename E>
+BPlusTree<E>::BPlusTree(std::function<int(const E&, const E&)> fn)
+{
+   root = NULL;
+   levels = -1;
+   keyCount = 0;
+   natural = false;
+   cmp = fn;
+}
+
+template <typename E>
+BPlusTree<E>::BPlusTree(BPlusTree<E>&& other) noexcept
+{
+   root = NULL;
+   levels = -1;
+   *this = std::move(other);
+}
+
+template <typename E>
+BPlusTree<E>& BPlusTree<E>::operator=(BPlusTree<E>&& other) noexcept
+{
+   if (this != &other)
+   {
+      destroy(root, levels);
+      root = other.root;
+      levels = other.levels;
+      keyCount = other.keyCount;
+      /* swapping never allocates or throws, as copying a comparator
+         can; the emptied tree is left in this tree's old order */
+      cmp.swap(other.cmp);
+      std::swap(natural, other.natural);
+      other.root = NULL;
+      other.levels = -1;
+      other.keyCount = 0;
+   }
+   return *this;
+}
+
+template <typename E>
+BPlusTree<E>::~BPlusTree()
+{
+   destroy(root, levels);
+}
+
+template <typename E>
+bool BPlusTree<E>::isEmpty() const
+{
+   return root == NULL;
+}
+
+template <typename E>
+void BPlusTree<E>::insert(const E& obj)
+{
+   if (root == NULL)
+   {
+      Leaf* leaf = new Leaf();
+      leaf->count = 1;
+      leaf->keys[0] = obj;
+      leaf->next = NULL;
+      root = leaf;
+      levels = 0;
+      keyCount = 1;
+      return;
+   }
+   if (root->count == CAPACITY)
+   {
+      Inner* top = new Inner();
+      top->count = 0;
+      top->children[0] = root;
+      splitChild(top, 0, levels == 0);
+      root = top;
+      levels++;
+   }
+   Node* node = root;
+   for (int level = levels; level > 0; level--)
+   {
+      Inner* inner = static_cast<Inner*>(node);
+      int i = upperBound(inner, obj);
+      if (inner->children[i]->count == CAPACITY)
+      {
+         splitChild(inner, i, level == 1);
+         if (cmp(obj, inner->keys[i]) >= 0)
+            i++;
+      }
+      node = inner->children[i];
+   }
+   int pos = lowerBound(node, obj);
+   if (pos < node->count && cmp(node->keys[pos], obj) == 0)
+   {
+      node->keys[pos] = obj;
+      return;
+   }
+   for (int j = node->count; j > pos; j--)
+      node->keys[j] = std::move(node->keys[j - 1]);
+   node->keys[pos] = obj;
+   node->count++;
+   keyCount++;
+}
+
+template <typename E>
+bool BPlusTree<E>::inTree(const E& item) const
+{
+   if (root == NULL)
+      return false;
+   Leaf* leaf = leafOf(item);
+   int pos = lowerBound(leaf, item);
+   return pos < leaf->count && cmp(leaf->keys[pos], item) == 0;
+}
+
+template <typename E>
+void BPlusTree<E>::remove(const E& item)
+{
+   if (root == NULL)
+      return;
+   Node* node = root;
+   for (int level = levels; level > 0; level--)
+   {
+      Inner* inner = static_cast<Inner*>(node);
+      int i = upperBound(inner, item);
+      if (inner->children[i]->count <= MINIMUM)
+         i = fixChild(inner, i, level == 1);
+      node = inner->children[i];
+   }
+   int pos = lowerBound(node, item);
+   if (pos < node->count && cmp(node->keys[pos], item) == 0)
+   {
+      for (int j = pos + 1; j < node->count; j++)
+         node->keys[j - 1] = std::move(node->keys[j]);
+      node->count--;
+      keyCount--;
+   }
+   /* a merge may have emptied the root of its separators */
+   if (levels > 0 && root->count == 0)
+   {
+      Inner* top = static_cast<Inner*>(root);
+      root = top->children[0];
+      delete top;
+      levels--;
+   }
+   else if (levels == 0 && root->count == 0)
+   {
+      delete static_cast<Leaf*>(root);
+      root = NULL;
+      levels = -1;
+   }
+}
+
+template <typename E>
+const E& BPlusTree<E>::retrieve(const E& key) const
+{
+   if (isEmpty())
+      throw AVLTreeException("AVL Tree Exception: tree empty on retrieve()");
+   Leaf* leaf = leafOf(key);
+   int pos = lowerBound(leaf, key);
+   if (pos == leaf->count || cmp(leaf->keys[pos], key) != 0)
+      throw AVLTreeException("AVL Tree Exception: key not in tree call to retrieve()");
+   return leaf->keys[pos];
+}
+
+template <typename E>
+void BPlusTree<E>::traverse(FuncType func) const
+{
+   if (root == NULL)
+      return;
+   Node* node = root;
+   for (int level = levels; level > 0; level--)
+      node = static_cast<Inner*>(node)->children[0];
+   for (Leaf* leaf = static_cast<Leaf*>(node); leaf != NULL; leaf = leaf->next)
+      for (int j = 0; j < leaf->count; j++)
+         func(leaf->keys[j]);
+}
+
+template <typename E>
+int BPlusTree<E>::size() const
+{
+   return keyCount;
+}
+
+template <typename E>
+int BPlusTree<E>::height() const
+{
+   return levels;
+}
+
+/* Private functions */
+
+template <typename E>
+int BPlusTree<E>::lowerBound(const Node* node, const E& key) const
+{
+   if (natural)
+   {
+      int below = 0;
+      for (int j = 0; j < node->count; j++)
+         below += node->keys[j] < key;
+      return below;
+   }
+   int lo = 0;
+   int hi = node->count;
+   while (lo < hi)
+   {
+      int mid = (lo + hi) / 2;
+      if (cmp(node->keys[mid], key) < 0)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
+template <typename E>
+int BPlusTree<E>::upperBound(const Node* node, const E& key) const
+{
+   if (natural)
+   {
+      int through = 0;
+      for (int j = 0; j < node->count; j++)
+         through += !(key < node->keys[j]);
+      return through;
+   }
+   int lo = 0;
+   int hi = node->count;
+   while (lo < hi)
+   {
+      int mid = (lo + hi) / 2;
+      if (cmp(node->keys[mid], key) <= 0)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
+template <typename E>
+typename BPlusTree<E>::Leaf* BPlusTree<E>::leafOf(const E& key) const
+{
+   Node* node = root;
+   for (int level = levels; level > 0; level--)
+   {
+      Inner* inner = static_cast<Inner*>(node);
+      node = inner->children[upperBound(inner, key)];
+   }
+   return static_cast<Leaf*>(node);
+}
+
+template <typename E>
+void BPlusTree<E>::splitChild(Inner* parent, int i, bool leaves)
+{
+   Node* child = parent->children[i];
+   Node* sibling;
+   int mid = CAPACITY / 2;
+   if (leaves)
+   {
+      /* leaves keep every key: the separator is a copy of the first key
+         of the new leaf */
+      Leaf* leaf = static_cast<Leaf*>(child);
+      Leaf* right = new Leaf();
+      right->count = CAPACITY - mid;
+      for (int j = 0; j < right->count; j++)
+         right->keys[j] = std::move(leaf->keys[mid + j]);
+      right->next = leaf->next;
+      leaf->next = right;
+      leaf->count = mid;
+      sibling = right;
+   }
+   else
+   {
+      /* the middle separator moves up */
+      Inner* inner = static_cast<Inner*>(child);
+      Inner* right = new Inner();
+      right->count = CAPACITY - mid - 1;
+      for (int j = 0; j < right->count; j++)
+         right->keys[j] = std::move(inner->keys[mid + 1 + j]);
+      for (int j = 0; j <= right->count; j++)
+         right->children[j] = inner->children[mid + 1 + j];
+      inner->count = mid;
+      sibling = right;
+   }
+   for (int j = parent->count; j > i; j--)
+   {
+      parent->keys[j] = std::move(parent->keys[j - 1]);
+      parent->children[j + 1] = parent->children[j];
+   }
+   parent->keys[i] = leaves ? sibling->keys[0] : std::move(child->keys[mid]);
+   parent->children[i + 1] = sibling;
+   parent->count++;
+}
+
+template <typename E>
+int BPlusTree<E>::fixChild(Inner* parent, int i, bool leaves)
+{
+   Node* child = parent->children[i];
+   Node* left = i > 0 ? parent->children[i - 1] : NULL;
+   Node* right = i < parent->count ? parent->children[i + 1] : NULL;
+   if (left != NULL && left->count > MINIMUM)
+   {
+      /* borrow the last key of the left sibling */
+      for (int j = child->count; j > 0; j--)
+         child->keys[j] = std::move(child->keys[j - 1]);
+      if (leaves)
+      {
+         child->keys[0] = std::move(left->keys[left->count - 1]);
+         parent->keys[i - 1] = child->keys[0];
+      }
+      else
+      {
+         Inner* to = static_cast<Inner*>(child);
+         Inner* from = static_cast<Inner*>(left);
+         for (int j = to->count + 1; j > 0; j--)
+            to->children[j] = to->children[j - 1];
+         to->keys[0] = std::move(parent->keys[i - 1]);
+         to->children[0] = from->children[from->count];
+         parent->keys[i - 1] = std::move(from->keys[from->count - 1]);
+      }
+      left->count--;
+      child->count++;
+      return i;
+   }
+   if (right != NULL && right->count > MINIMUM)
+   {
+      /* borrow the first key of the right sibling */
+      if (leaves)
+      {
+         child->keys[child->count] = std::move(right->keys[0]);
+         for (int j = 1; j < right->count; j++)
+            right->keys[j - 1] = std::move(right->keys[j]);
+         parent->keys[i] = right->keys[0];
+      }
+      else
+      {
+         Inner* to = static_cast<Inner*>(child);
+         Inner* from = static_cast<Inner*>(right);
+         to->keys[to->count] = std::move(parent->keys[i]);
+         to->children[to->count + 1] = from->children[0];
+         parent->keys[i] = std::move(from->keys[0]);
+         for (int j = 1; j < from->count; j++)
+            from->keys[j - 1] = std::move(from->keys[j]);
+         for (int j = 1; j <= from->count; j++)
+            from->children[j - 1] = from->children[j];
+      }
+      right->count--;
+      child->count++;
+      return i;
+   }
+   /* both siblings are at the minimum: merge with one of them */
+   if (left != NULL)
+   {
+      right = child;
+      i--;
+   }
+   else
+      left = child;
+   if (leaves)
+   {
+      for (int j = 0; j < right->count; j++)
+         left->keys[left->count + j] = std::move(right->keys[j]);
+      left->count += right->count;
+      static_cast<Leaf*>(left)->next = static_cast<Leaf*>(right)->next;
+      delete static_cast<Leaf*>(right);
+   }
+   else
+   {
+      Inner* to = static_cast<Inner*>(left);
+      Inner* from = static_cast<Inner*>(right);
+      to->keys[to->count] = std::move(parent->keys[i]);
+      for (int j = 0; j < from->count; j++)
+         to->keys[to->count + 1 + j] = std::move(from->keys[j]);
+      for (int j = 0; j <= from->count; j++)
+         to->children[to->count + 1 + j] = from->children[j];
+      to->count += 1 + from->count;
+      delete from;
+   }
+   for (int j = i + 1; j < parent->count; j++)
+   {
+      parent->keys[j - 1] = std::move(parent->keys[j]);
+      parent->children[j] = parent->children[j + 1];
+   }
+   parent->count--;
+   return i;
+}
+
+template <typename E>
+void BPlusTree<E>::destroy(Node* node, int height)
+{
+   if (node == NULL)
+      return;
+   if (height == 0)
+   {
+      delete static_cast<Leaf*>(node);
+      return;
+   }
+   Inner* inner = static_cast<Inner*>(node);
+   for (int j = 0; j <= inner->count; j++)
+      destroy(inner->children[j], height - 1);
+   delete inner;
+}
+
+//BPLUSTREE_CPP
+#endif
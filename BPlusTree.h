@@ -0,0 +1,241 @@
+/**
+ * Models an ordered set on a B+-tree of fat nodes
+ * @author William Duncan, Cody Carter
+ * <pre>
+ * File: BPlusTree.h
+ * Date: 10/18/2023
+ * </pre>
+ */
+
+#include <functional>
+#include "AVLTree.h"
+
+#ifndef BPLUSTREE_H
+#define BPLUSTREE_H
+
+using namespace std;
+
+/**
+ * Describes an ordered container with the public surface of AVLTree whose
+ * keys are kept in fat nodes: each node stores its keys contiguously, in
+ * about 512 bytes, and all keys live in leaves chained in order. A lookup
+ * touches one node per level, so a tree of tens of millions of keys is
+ * only a handful of levels deep. Nodes are split on the way down an
+ * insertion and topped up from a sibling on the way down a deletion, so
+ * every operation makes exactly one descent.
+ * @param <E> the data type
+ * @see AVLTree
+ * @see AVLTreeException
+ */
+template <typename E>
+class BPlusTree
+{
+private:
+   typedef std::function<void(const E&)> FuncType;
+   /**
+    * the most keys a node holds
+    */
+   static const int CAPACITY = 512 / sizeof(E) < 8 ? 8 : 512 / sizeof(E);
+   /**
+    * the fewest keys a node other than the root holds
+    */
+   static const int MINIMUM = (CAPACITY - 1) / 2;
+
+   /**
+    * The part common to leaves and inner nodes
+    */
+   struct Node
+   {
+      /**
+       * the number of keys in this node
+       */
+      int count;
+      /**
+       * the keys of this node in order
+       */
+      E keys[CAPACITY];
+   };
+
+   /**
+    * A leaf: the keys of the tree, chained in order
+    */
+   struct Leaf : Node
+   {
+      /**
+       * the next leaf in order
+       */
+      Leaf* next;
+   };
+
+   /**
+    * An inner node: child i holds the keys from separator i - 1 up to,
+    * but not including, separator i
+    */
+   struct Inner : Node
+   {
+      /**
+       * the children of this node; one more than its keys
+       */
+      Node* children[CAPACITY + 1];
+   };
+
+   /**
+    * the root of the tree; a leaf when the height is 0
+    */
+   Node* root;
+   /**
+    * the height of the tree; -1 when it is empty
+    */
+   int levels;
+   /**
+    * the number of keys in the tree
+    */
+   int keyCount;
+   /**
+    * indicates whether the keys are ordered by their < operator, in which
+    * case nodes are searched by a branch-free scan the compiler vectorizes
+    */
+   bool natural;
+   /**
+    * A trichotomous integer-value comparator function
+    */
+   std::function<int(const E&, const E&)> cmp;
+
+   /**
+    * Gives the number of keys in a node that precede a search key
+    * @param node a node
+    * @param key the search key
+    * @return the index of the first key not less than the search key
+    */
+   int lowerBound(const Node* node, const E& key) const;
+
+   /**
+    * Gives the number of keys in a node that do not follow a search key
+    * @param node a node
+    * @param key the search key
+    * @return the index of the first key greater than the search key
+    */
+   int upperBound(const Node* node, const E& key) const;
+
+   /**
+    * Gives the leaf that would hold the specified key
+    * @param key the search key
+    * @return the leaf whose range spans the key
+    */
+   Leaf* leafOf(const E& key) const;
+
+   /**
+    * Splits a full child in two and adds the separator to its parent
+    * @param parent an inner node that is not full
+    * @param i the index of the full child
+    * @param leaves indicates whether the children are leaves
+    */
+   void splitChild(Inner* parent, int i, bool leaves);
+
+   /**
+    * Tops up a child holding the fewest keys allowed, borrowing a key
+    * from a sibling or merging with one
+    * @param parent an inner node
+    * @param i the index of the child
+    * @param leaves indicates whether the children are leaves
+    * @return the index of the child that now spans the child's range
+    */
+   int fixChild(Inner* parent, int i, bool leaves);
+
+   /**
+    * Frees every node of a subtree
+    * @param node the root of the subtree
+    * @param height the height of the subtree
+    */
+   static void destroy(Node* node, int height);
+public:
+   /**
+    * Constructs an empty tree ordered by the < operator
+    */
+   BPlusTree();
+
+   /**
+    * Constructs an empty tree ordered by the specified comparator
+    * @param fn - an integer-value binary comparator function
+    */
+   BPlusTree(std::function<int(const E&, const E&)> fn);
+
+   BPlusTree(const BPlusTree<E>& other) = delete;
+
+   /**
+    * Constructs a tree by taking over the nodes of another tree
+    * @param other the tree to move from; it is left empty
+    */
+   BPlusTree(BPlusTree<E>&& other) noexcept;
+
+   BPlusTree<E>& operator=(const BPlusTree<E>& other) = delete;
+
+   /**
+    * Frees the nodes of this tree and takes over those of another tree
+    * @param other the tree to move from; it is left empty
+    * @return this tree
+    */
+   BPlusTree<E>& operator=(BPlusTree<E>&& other) noexcept;
+
+   /**
+    * destructor - frees all nodes of this tree
+    */
+   ~BPlusTree();
+
+   /**
+    * Determine whether the tree is empty.
+    * @return true if the tree is empty; otherwise, false
+    */
+   bool isEmpty() const;
+
+   /**
+    * Inserts an item into the tree; an item that is already in the tree
+    * is replaced
+    * @param obj the value to be inserted.
+    */
+   void insert(const E& obj);
+
+   /**
+    * Determine whether an item is in the tree.
+    * @param item item with a specified search key.
+    * @return true on success; false on failure.
+    */
+   bool inTree(const E& item) const;
+
+   /**
+    * Delete an item from the tree.
+    * @param item item with a specified search key.
+    */
+   void remove(const E& item);
+
+   /**
+    * returns a reference to the specified item in the tree
+    * @param item item with a specified search key.
+    * @return the item with the specified key
+    * @throws AVLTreeException when the item is not in the tree
+    */
+   const E& retrieve(const E& key) const;
+
+   /**
+    * This function traverses the tree in in-order
+    * and calls the function Visit once for each node.
+    * @param func the function to apply to the data in each node
+    */
+   void traverse(FuncType func) const;
+
+   /**
+    * Returns the number of keys in the tree.
+    * @return the number of keys in the tree.
+    */
+   int size() const;
+
+   /**
+    * Gives the height of this tree: the number of inner levels above the
+    * leaves
+    * @return the height of this tree; -1 when it is empty
+    */
+   int height() const;
+};
+
+//BPLUSTREE_H
+#endif
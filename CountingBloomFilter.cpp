@@ -0,0 +1,154 @@
+/**
+ * Models a counting Bloom filter.
+ * @author William Duncan, Cody Carter
+ * @see CountingBloomFilter
+ * <pre>
+ * Date: 10/18/2023
+ * </pre>
+ */
+#ifndef COUNTINGBLOOMFILTER_CPP
+#define COUNTINGBLOOMFILTER_CPP
+
+#include <algorithm>
+#include <cmath>
+#include "CountingBloomFilter.h"
+
+using namespace std;
+
+inline CountingBloomFilter::CountingBloomFilter(size_t expectedKeys, double falsePositiveRate, size_t maxBytes)
+   : keys(0), capacity(expectedKeys), rate(falsePositiveRate), budget(maxBytes),
+     queries(0), rejections(0), falsePositives(0)
+{
+   double ln2 = log(2.0);
+   double wanted = ceil(-(double)expectedKeys * log(falsePositiveRate) / (ln2 * ln2));
+   if (budget > 0 && wanted > 2.0 * budget)
+      wanted = 2.0 * budget;
+   if (wanted > 4294967295.0)
+      wanted = 4294967295.0;
+   counters = wanted < 64 ? 64 : (size_t)wanted;
+   hashes = (int)lround((double)counters / (expectedKeys > 0 ? expectedKeys : 1) * ln2);
+   if (hashes < 1)
+      hashes = 1;
+   if (hashes > 16)
+      hashes = 16;
+   nibbles.assign((counters + 1) / 2, 0);
+}
+
+inline CountingBloomFilter::CountingBloomFilter(const CountingBloomFilter& other)
+   : nibbles(other.nibbles), counters(other.counters), hashes(other.hashes),
+     keys(other.keys), capacity(other.capacity), rate(other.rate), budget(other.budget),
+     queries(other.queries.load(memory_order_relaxed)),
+     rejections(other.rejections.load(memory_order_relaxed)),
+     falsePositives(other.falsePositives.load(memory_order_relaxed))
+{
+}
+
+inline void CountingBloomFilter::add(uint64_t hash)
+{
+   uint64_t mixed = mix(hash);
+   for (int i = 0; i < hashes; i++)
+   {
+      size_t at = slot(mixed, i);
+      int count = get(at);
+      if (count < 15)
+         set(at, count + 1);
+   }
+   keys++;
+}
+
+inline void CountingBloomFilter::remove(uint64_t hash)
+{
+   uint64_t mixed = mix(hash);
+   for (int i = 0; i < hashes; i++)
+   {
+      size_t at = slot(mixed, i);
+      int count = get(at);
+      if (count > 0 && count < 15)
+         set(at, count - 1);
+   }
+   keys--;
+}
+
+inline bool CountingBloomFilter::mayContain(uint64_t hash) const
+{
+   queries.fetch_add(1, memory_order_relaxed);
+   uint64_t mixed = mix(hash);
+   for (int i = 0; i < hashes; i++)
+      if (get(slot(mixed, i)) == 0)
+      {
+         rejections.fetch_add(1, memory_order_relaxed);
+         return false;
+      }
+   return true;
+}
+
+inline void CountingBloomFilter::reset()
+{
+   fill(nibbles.begin(), nibbles.end(), 0);
+   keys = 0;
+}
+
+inline bool CountingBloomFilter::overloaded() const
+{
+   return keys > capacity && (budget == 0 || counters < 2 * budget) && counters < 4294967295.0;
+}
+
+inline size_t CountingBloomFilter::size() const
+{
+   return keys;
+}
+
+inline double CountingBloomFilter::targetRate() const
+{
+   return rate;
+}
+
+inline size_t CountingBloomFilter::maxBytes() const
+{
+   return budget;
+}
+
+inline AVLFilterStats CountingBloomFilter::stats() const
+{
+   AVLFilterStats result;
+   result.counters = counters;
+   result.bytes = nibbles.size();
+   result.hashes = hashes;
+   result.keys = keys;
+   result.queries = queries.load(memory_order_relaxed);
+   result.rejections = rejections.load(memory_order_relaxed);
+   result.falsePositives = falsePositives.load(memory_order_relaxed);
+   result.expectedFalsePositiveRate = pow(1 - exp(-(double)hashes * keys / counters), hashes);
+   return result;
+}
+
+/* Private functions */
+
+inline uint64_t CountingBloomFilter::mix(uint64_t hash)
+{
+   hash ^= hash >> 30;
+   hash *= 0xbf58476d1ce4e5b9ULL;
+   hash ^= hash >> 27;
+   hash *= 0x94d049bb133111ebULL;
+   return hash ^ (hash >> 31);
+}
+
+inline size_t CountingBloomFilter::slot(uint64_t mixed, int i) const
+{
+   uint32_t probe = (uint32_t)mixed + i * ((uint32_t)(mixed >> 32) | 1);
+   return (size_t)(((uint64_t)probe * counters) >> 32);
+}
+
+inline int CountingBloomFilter::get(size_t at) const
+{
+   return (nibbles[at / 2] >> (at % 2 * 4)) & 15;
+}
+
+inline void CountingBloomFilter::set(size_t at, int value)
+{
+   int shift = at % 2 * 4;
+   nibbles[at / 2] = (uint8_t)((nibbles[at / 2] & ~(15 << shift)) | (value << shift));
+}
+
+//COUNTINGBLOOMFILTER_CPP
+#endif
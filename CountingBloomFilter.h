@@ -0,0 +1,276 @@
+/**
+ * Models a counting Bloom filter and the key hashes it is fed
+ * @author William Duncan, Cody Carter
+ * <pre>
+ * File: CountingBloomFilter.h
+ * Date: 10/18/2023
+ * </pre>
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#ifndef COUNTINGBLOOMFILTER_H
+#define COUNTINGBLOOMFILTER_H
+
+using namespace std;
+
+/**
+ * The state and effectiveness of the Bloom filter of an AVL tree
+ * @see AVLTree::useFilter
+ */
+struct AVLFilterStats
+{
+   /**
+    * the number of counters in the filter; 0 when it is off
+    */
+   size_t counters;
+   /**
+    * the bytes taken by the counters
+    */
+   size_t bytes;
+   /**
+    * the number of counters each key sets
+    */
+   int hashes;
+   /**
+    * the number of keys counted in the filter
+    */
+   size_t keys;
+   /**
+    * the lookups that consulted the filter
+    */
+   unsigned long queries;
+   /**
+    * the lookups the filter answered, without a descent, because their
+    * key was certainly absent
+    */
+   unsigned long rejections;
+   /**
+    * the lookups the filter let through for a key that was absent
+    */
+   unsigned long falsePositives;
+   /**
+    * the false-positive rate expected at the current load of the filter
+    */
+   double expectedFalsePositiveRate;
+   /**
+    * Gives the fraction of lookups of absent keys that the filter answered
+    * @return the rejections over all lookups of absent keys; 0 before the
+    * first such lookup
+    */
+   double effectiveness() const
+   {
+      unsigned long absent = rejections + falsePositives;
+      return absent == 0 ? 0 : (double)rejections / absent;
+   }
+};
+
+/**
+ * A counting Bloom filter over hashes: each key increments, and on
+ * removal decrements, the 4-bit counters at k positions derived from its
+ * hash by double hashing, so a key with any of its counters at zero is
+ * certainly absent. A counter that reaches 15 sticks there, which can
+ * only cost false positives. The filter is sized for a number of keys and
+ * a false-positive rate, within an optional memory budget.
+ */
+class CountingBloomFilter
+{
+private:
+   /**
+    * the counters, two to a byte
+    */
+   vector<uint8_t> nibbles;
+   /**
+    * the number of counters
+    */
+   size_t counters;
+   /**
+    * the number of counters each key sets
+    */
+   int hashes;
+   /**
+    * the number of keys counted
+    */
+   size_t keys;
+   /**
+    * the number of keys the filter was sized for
+    */
+   size_t capacity;
+   /**
+    * the false-positive rate the filter was sized for
+    */
+   double rate;
+   /**
+    * the most bytes the counters may take; 0 for no limit
+    */
+   size_t budget;
+
+   /**
+    * Spreads the bits of a hash, which for integers may be the integer
+    * itself, over all 64 bits
+    * @param hash a hash
+    * @return the mixed hash
+    */
+   static uint64_t mix(uint64_t hash);
+
+   /**
+    * Gives the position of one of the counters of a key
+    * @param mixed the mixed hash of the key
+    * @param i the index of the counter, below the number of hashes
+    * @return the position of the counter
+    */
+   size_t slot(uint64_t mixed, int i) const;
+
+   /**
+    * Gives the value of a counter
+    * @param at the position of the counter
+    * @return the value of the counter, from 0 to 15
+    */
+   int get(size_t at) const;
+
+   /**
+    * Sets the value of a counter
+    * @param at the position of the counter
+    * @param value the new value of the counter, from 0 to 15
+    */
+   void set(size_t at, int value);
+public:
+   /**
+    * the lookups that consulted the filter; counted with relaxed atomic
+    * increments, as are the two below, so that const lookups may run on
+    * several threads at once
+    */
+   mutable atomic<unsigned long> queries;
+   /**
+    * the lookups answered as certainly absent
+    */
+   mutable atomic<unsigned long> rejections;
+   /**
+    * the lookups let through for an absent key
+    */
+   mutable atomic<unsigned long> falsePositives;
+
+   /**
+    * Constructs an empty filter
+    * @param expectedKeys the number of keys to size the filter for
+    * @param falsePositiveRate the false-positive rate to size it for
+    * @param maxBytes the most bytes the counters may take, which caps the
+    * number of counters at the cost of the rate; 0 for no limit
+    */
+   CountingBloomFilter(size_t expectedKeys, double falsePositiveRate, size_t maxBytes);
+
+   /**
+    * Constructs a copy of a filter, counts included
+    * @param other the filter to be copied
+    */
+   CountingBloomFilter(const CountingBloomFilter& other);
+
+   /**
+    * Counts a key
+    * @param hash the hash of the key
+    */
+   void add(uint64_t hash);
+
+   /**
+    * Uncounts a key that was counted
+    * @param hash the hash of the key
+    */
+   void remove(uint64_t hash);
+
+   /**
+    * Determines whether a key may have been counted
+    * @param hash the hash of the key
+    * @return false when the key is certainly not counted; otherwise, true
+    */
+   bool mayContain(uint64_t hash) const;
+
+   /**
+    * Uncounts every key
+    */
+   void reset();
+
+   /**
+    * Determines whether the filter holds more keys than it was sized for
+    * and a larger filter would fit in its budget
+    * @return true when the filter should be rebuilt larger
+    */
+   bool overloaded() const;
+
+   /**
+    * Gives the number of keys counted
+    * @return the number of keys counted
+    */
+   size_t size() const;
+
+   /**
+    * Gives the false-positive rate the filter was sized for
+    * @return the target false-positive rate
+    */
+   double targetRate() const;
+
+   /**
+    * Gives the memory budget of the filter
+    * @return the most bytes the counters may take; 0 for no limit
+    */
+   size_t maxBytes() const;
+
+   /**
+    * Gives the state and effectiveness of this filter
+    * @return the size, load and hit counts of this filter
+    */
+   AVLFilterStats stats() const;
+};
+
+/**
+ * Hashes an element with std::hash when there is one for its type
+ * @param item an element
+ * @return the hash of the element
+ */
+template <typename E>
+inline auto hashedKey(const E& item, int) -> decltype(std::hash<E>()(item))
+{
+   return std::hash<E>()(item);
+}
+
+/**
+ * Hashes an element of a type with no std::hash: all such elements share
+ * one hash
+ * @param item an element
+ * @return 0
+ */
+template <typename E>
+inline size_t hashedKey(const E&, long)
+{
+   return 0;
+}
+
+/**
+ * Gives the hash that the hot-key cache of a tree files an element under
+ * @param item an element
+ * @return the hash of the element
+ */
+template <typename E>
+inline size_t keyHash(const E& item)
+{
+   return hashedKey(item, 0);
+}
+
+/**
+ * Gives the hash of a key-value pair: that of its key, so that the value
+ * can change in place without moving the pair in the cache
+ * @param item a key-value pair
+ * @return the hash of the key
+ */
+template <typename K, typename V>
+inline size_t keyHash(const pair<K,V>& item)
+{
+   return keyHash(item.first);
+}
+
+//COUNTINGBLOOMFILTER_H
+#endif
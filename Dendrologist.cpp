@@ -16,232 +16,703 @@
 #include <fstream> 
 #include <algorithm>
 #include <vector>
+#include <map>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <atomic>
+#include <thread>
 #include "AVLTree.cpp"
 
 using namespace std;
 
-int main(int argc, char** argv) 
+/**
+ * Records latencies in HDR-style log-linear buckets: every power of two
+ * is split into 32 equal sub-buckets, so any recorded value is reported
+ * within about 3% of its true value using a fixed 2KB table.
+ */
+class LatencyHistogram
 {
-    string usage = "Dendrologist <order-code> <command-file>\n";
-    usage += "  <order-code>:\n";
-    usage += "  0 ordered by increasing string length, primary key, and reverse lexicographical order, secondary key\n";
-    usage += "  -1 for reverse lexicographical order\n";
-    usage += "  1 for lexicographical order\n";
-    usage += "  -2 ordered by decreasing string length\n";
-    usage += "  2 ordered by increasing string length\n";
-    usage += "  -3 ordered by decreasing string length, primary key, and reverse lexicographical order, secondary key\n";
-    usage += "  3 ordered by increasing string length, primary key, and lexicographical order, secondary key\n";  
-    if (argc != 3)
+private:
+   /**
+    * the number of sub-buckets per power of two
+    */
+   static const int SUB_BUCKETS = 32;
+   /**
+    * the bucket counts; values below 2*SUB_BUCKETS are recorded exactly
+    */
+   vector<uint64_t> buckets;
+   /**
+    * the number of recorded values
+    */
+   uint64_t total;
+   /**
+    * the largest recorded value
+    */
+   uint64_t largest;
+
+   /**
+    * Gives the bucket that records the specified value
+    * @param value a latency in nanoseconds
+    * @return the index of the bucket for this value
+    */
+   static int bucketOf(uint64_t value)
+   {
+      if (value < 2 * SUB_BUCKETS)
+         return (int)value;
+      int msb = 63 - __builtin_clzll(value);
+      int shift = msb - 5;
+      return 2 * SUB_BUCKETS + (shift - 1) * SUB_BUCKETS + (int)(value >> shift) - SUB_BUCKETS;
+   }
+
+   /**
+    * Gives the largest value that is recorded in the specified bucket
+    * @param index the index of a bucket
+    * @return the highest value equivalent to the values in this bucket
+    */
+   static uint64_t highestIn(int index)
+   {
+      if (index < 2 * SUB_BUCKETS)
+         return index;
+      int shift = (index - 2 * SUB_BUCKETS) / SUB_BUCKETS + 1;
+      uint64_t mantissa = (index - 2 * SUB_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+      return ((mantissa + 1) << shift) - 1;
+   }
+public:
+   /**
+    * Constructs an empty histogram
+    */
+   LatencyHistogram() : buckets(2 * SUB_BUCKETS + 58 * SUB_BUCKETS, 0), total(0), largest(0)
+   {
+   }
+
+   /**
+    * Records a latency
+    * @param nanos the latency in nanoseconds
+    */
+   void record(uint64_t nanos)
+   {
+      buckets[bucketOf(nanos)]++;
+      total++;
+      if (nanos > largest)
+         largest = nanos;
+   }
+
+   /**
+    * Gives the number of recorded latencies
+    * @return the number of values recorded in this histogram
+    */
+   uint64_t size() const
+   {
+      return total;
+   }
+
+   /**
+    * Gives the largest recorded latency
+    * @return the maximum value recorded in this histogram
+    */
+   uint64_t max() const
+   {
+      return largest;
+   }
+
+   /**
+    * Gives the latency at the specified percentile
+    * @param p a percentile in the range [0, 100]
+    * @return the smallest recorded value such that p percent of the
+    * values are at or below it
+    */
+   uint64_t percentile(double p) const
+   {
+      if (total == 0)
+         return 0;
+      uint64_t rank = (uint64_t)(p / 100.0 * total + 0.5);
+      if (rank < 1)
+         rank = 1;
+      uint64_t seen = 0;
+      for (size_t i = 0; i < buckets.size(); i++)
+      {
+         seen += buckets[i];
+         if (seen >= rank)
+            return std::min(highestIn((int)i), largest);
+      }
+      return largest;
+   }
+};
+
+/**
+ * Prints the per-command latency distributions and the overall throughput
+ * @param os the output stream
+ * @param profile the latency histogram of each command type
+ * @param elapsed the wall-clock time spent replaying the command file
+ */
+void printProfile(ostream& os, const map<string, LatencyHistogram>& profile,
+                  chrono::nanoseconds elapsed)
+{
+    uint64_t commands = 0;
+    for (const auto& entry : profile)
+        commands += entry.second.size();
+    double seconds = elapsed.count() / 1e9;
+    os<<"Profile: "<<commands<<" commands in "<<fixed<<setprecision(6)<<seconds<<" s";
+    if (seconds > 0)
+        os<<" ("<<setprecision(0)<<commands / seconds<<" commands/sec)";
+    os<<endl;
+    os<<left<<setw(10)<<"command"<<right<<setw(10)<<"count"<<setw(12)<<"p50(us)"
+      <<setw(12)<<"p99(us)"<<setw(12)<<"p999(us)"<<setw(12)<<"max(us)"<<endl;
+    os<<setprecision(3);
+    for (const auto& entry : profile)
     {
-        cout<<usage<<endl;
-        throw invalid_argument("There should be 3 command line arguments.");
-    }
-    
-    int sortCode = stoi(argv[1]);
-    string filename = argv[2];
-    AVLTree<string> Tree;
-function<int(string, string)> compare;
-switch (sortCode) {
-        case -3:
-            compare = [](string s1, string s2) {
-                int length = s2.length() - s1.length();
-                if (length == 0) {
-                    return s2.compare(s1);
-                }
-                return length;
-            };
-            Tree = AVLTree<string>(compare);
-            break;
-        case -2:
-            compare = [](string s1, string s2) {
-                return s2.length() - s1.length();
-            };
-            Tree = AVLTree<string>(compare);
-            break;
-        case -1:
-            compare = [](string s1, string s2) {
-                return s2.compare(s1);
-            };
-            Tree = AVLTree<string>(compare);
-            break;
-        case 0:
-            compare = [](string s1, string s2) {
-                int length = s1.length() - s2.length();
-                if (length == 0) {
-                    return s2.compare(s1);
-                }
-                return length;
-            };
-            Tree = AVLTree<string>(compare);
-            break;
-        case 1:
-            compare = [](string s1, string s2) {
-                return s1.compare(s2);
-            };
-            Tree = AVLTree<string>(compare);
-            break;
-        case 2:
-            compare = [](string s1, string s2) {
-                return s1.length() - s2.length();
-            };
-            Tree = AVLTree<string>(compare);
-            break;
-        case 3:
-            compare = [](string s1, string s2) {
-                int length = s1.length() - s2.length();
-                if (length == 0) {
-                    return s1.compare(s2);
-                }
-                return length;
-            };
-            Tree = AVLTree<string>(compare);
-            break;
-        default:
-            cout << "Invalid sortcode" << endl;
-            break;
+        const LatencyHistogram& h = entry.second;
+        os<<left<<setw(10)<<entry.first<<right<<setw(10)<<h.size()
+          <<setw(12)<<h.percentile(50) / 1e3<<setw(12)<<h.percentile(99) / 1e3
+          <<setw(12)<<h.percentile(99.9) / 1e3<<setw(12)<<h.max() / 1e3<<endl;
     }
+}
+
+/**
+ * A bounded single-producer, single-consumer queue on a ring buffer. The
+ * producer only writes the tail and the consumer only writes the head, so
+ * neither side takes a lock; each side spins, yielding, while the ring is
+ * full or empty, and adds the time it waited to its own counter.
+ * @param <T> the type of the queued items
+ */
+template <typename T>
+class SpscQueue
+{
+private:
+   /**
+    * the ring buffer; its size is a power of two
+    */
+   vector<T> slots;
+   /**
+    * one less than the size of the ring
+    */
+   size_t mask;
+   /**
+    * the number of items popped; written only by the consumer
+    */
+   alignas(64) atomic<size_t> head;
+   /**
+    * the number of items pushed; written only by the producer
+    */
+   alignas(64) atomic<size_t> tail;
+   /**
+    * indicates whether the producer has pushed its last item
+    */
+   alignas(64) atomic<bool> closed;
+   /**
+    * the nanoseconds the producer waited on a full ring
+    */
+   alignas(64) uint64_t producerWait;
+   /**
+    * the nanoseconds the consumer waited on an empty ring
+    */
+   alignas(64) uint64_t consumerWait;
+public:
+   /**
+    * Constructs an empty queue
+    * @param capacity the least number of items the queue holds; rounded
+    * up to a power of two
+    */
+   SpscQueue(size_t capacity) : head(0), tail(0), closed(false), producerWait(0), consumerWait(0)
+   {
+      size_t size = 1;
+      while (size < capacity)
+         size *= 2;
+      slots.resize(size);
+      mask = size - 1;
+   }
 
+   /**
+    * Appends an item, waiting while the queue is full; called only by
+    * the producer
+    * @param item the item to append
+    */
+   void push(T item)
+   {
+      size_t at = tail.load(memory_order_relaxed);
+      if (at - head.load(memory_order_acquire) == slots.size())
+      {
+         auto start = chrono::steady_clock::now();
+         while (at - head.load(memory_order_acquire) == slots.size())
+            this_thread::yield();
+         producerWait += chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - start).count();
+      }
+      slots[at & mask] = std::move(item);
+      tail.store(at + 1, memory_order_release);
+   }
 
-ifstream txtFile(filename);
-string line;
+   /**
+    * Removes the oldest item, waiting while the queue is empty; called
+    * only by the consumer
+    * @param item receives the removed item
+    * @return true when an item was removed; false when the queue is empty
+    * and closed
+    */
+   bool pop(T& item)
+   {
+      size_t at = head.load(memory_order_relaxed);
+      if (tail.load(memory_order_acquire) == at)
+      {
+         auto start = chrono::steady_clock::now();
+         /* the last push is ordered before close, so a closed queue whose
+            tail has not moved is drained */
+         while (tail.load(memory_order_acquire) == at && !closed.load(memory_order_acquire))
+            this_thread::yield();
+         consumerWait += chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - start).count();
+         if (tail.load(memory_order_acquire) == at)
+            return false;
+      }
+      item = std::move(slots[at & mask]);
+      head.store(at + 1, memory_order_release);
+      return true;
+   }
 
-while (getline(txtFile, line))
+   /**
+    * Marks the end of the items; called by the producer after its last push
+    */
+   void close()
+   {
+      closed.store(true, memory_order_release);
+   }
+
+   /**
+    * Gives the time the producer spent waiting on a full queue
+    * @return the waiting time in nanoseconds
+    */
+   uint64_t producerWaiting() const
+   {
+      return producerWait;
+   }
+
+   /**
+    * Gives the time the consumer spent waiting on an empty queue
+    * @return the waiting time in nanoseconds
+    */
+   uint64_t consumerWaiting() const
+   {
+      return consumerWait;
+   }
+};
+
+/**
+ * A line of a command file split into its command and parameter, the
+ * parameter being normalized for the order of the tree
+ */
+struct Command
 {
+   /**
+    * the command name; empty for a blank line
+    */
+   string name;
+   /**
+    * the first argument of the command, if any
+    */
+   NormalizedKey parameter;
+};
+
+/**
+ * What a command read from the tree, kept apart from how it is printed so
+ * that the printing can run on another thread while the tree moves on
+ */
+struct Reply
+{
+   /**
+    * the command that was executed
+    */
+   Command command;
+   /**
+    * whether the command is one the tree understands
+    */
+   bool known;
+   /**
+    * gen: whether the entry is in the tree
+    */
+   bool found;
+   /**
+    * traverse: the pre-, in- and post-order sequences one after another;
+    * gen: the parent and the left and right children
+    */
+   vector<string> words;
+   /**
+    * traverse: the length of each sequence; gen: the ancestors and
+    * descendants; props: the size, height, diameter and the two shape
+    * flags; mem: the memory usage fields and their total
+    */
+   vector<long long> numbers;
+};
+
+/**
+ * Splits a line of a command file into its command and parameter
+ * @param line a line of a command file
+ * @param normalize the normalizer for the order of the tree
+ * @return the command on the line
+ */
+Command parse(const string& line, const KeyNormalizer& normalize)
+{
+    Command command;
+    string parameter;
     istringstream iss(line);
-    string command;
-    iss >> command;
+    iss >> command.name >> parameter;
+    command.parameter = normalize(parameter);
+    return command;
+}
+
+/**
+ * Executes a command against a tree
+ * @param Tree the tree
+ * @param command the command to execute
+ * @return what the command read from the tree
+ */
+template <typename T>
+Reply execute(T& Tree, const Command& command)
+{
+    Reply reply;
+    reply.command = command;
+    reply.known = true;
+    reply.found = false;
+    const string& name = command.name;
+    if (name == "insert")
+    {
+        Tree.insert(command.parameter);
+    }
+    else if (name == "delete")
+    {
+        Tree.remove(command.parameter);
+    }
+    else if (name == "traverse")
+    {
+        vector<string>& words = reply.words;
+        auto collect = [&words](const NormalizedKey& data) { words.push_back(data.text); };
+        Tree.preorderTraverse(collect);
+        reply.numbers.push_back(words.size());
+        Tree.traverse(collect);
+        reply.numbers.push_back(words.size() - reply.numbers[0]);
+        Tree.postorderTraverse(collect);
+    }
+    else if (name == "gen")
+    {
+        /* one descent finds the node; the rest is read off the cursor */
+        auto at = Tree.locate(command.parameter);
+        reply.found = at.isValid();
+        if (reply.found)
+        {
+            const NormalizedKey* parent = at.parent();
+            const NormalizedKey* left = at.left();
+            const NormalizedKey* right = at.right();
+            reply.words.push_back(parent == nullptr ? string("NULL") : parent->text);
+            reply.words.push_back(left == nullptr ? string("None") : left->text);
+            reply.words.push_back(right == nullptr ? string("None") : right->text);
+            reply.numbers.push_back(at.depth());
+            reply.numbers.push_back(at.descendants());
+        }
+    }
+    else if (name == "props")
+    {
+        reply.numbers = {Tree.size(), Tree.height(), Tree.diameter(),
+                         Tree.isFibonacci(), Tree.isComplete()};
+    }
+    else if (name == "mem")
+    {
+        AVLMemoryUsage usage = Tree.memoryUsage();
+        reply.numbers = {(long long)usage.nodes, (long long)usage.nodeBytes,
+                         (long long)usage.keyBytes, (long long)usage.allocatorBytes,
+                         (long long)usage.total()};
+    }
+    else
+    {
+        reply.known = false;
+    }
+    return reply;
+}
 
-    if (command == "insert") 
+/**
+ * Prints the output of an executed command
+ * @param out the output stream
+ * @param reply what the command read from the tree
+ * @return false when the command is not known; otherwise, true
+ */
+bool format(ostream& out, const Reply& reply)
+{
+    const string& name = reply.command.name;
+    const string& parameter = reply.command.parameter.text;
+    if (!reply.known)
     {
-        string parameter;
-        iss >> parameter;
-        cout<<"Inserted "<<parameter<<endl;
-        Tree.insert(parameter);
+        cerr << "Unknown command: " << name << endl;
+        return false;
+    }
+    if (name == "insert") 
+    {
+        out<<"Inserted "<<parameter<<endl;
     } 
-    else if (command == "delete") 
+    else if (name == "delete") 
     {
-        string parameter;
-        iss >> parameter;
-        cout<<"Deleted "<<parameter<<endl;
-        Tree.remove(parameter);
+        out<<"Deleted "<<parameter<<endl;
     } 
-    else if (command == "traverse")
-    {
-        string parameter;
-        iss >> parameter;
-        cout<<"Pre-Order Traversal "<<endl;
-            Tree.preorderTraverse([](auto& data)
-                {
-                    cout << data <<endl;
-                });
-    
-        cout<<"In-Order Traversal "<<endl;
-            Tree.traverse([](auto& data)
-                {      
-                    cout << data <<endl;
-                });
-   
-        cout<<"Post-Order Traversal "<<endl;
-            Tree.postorderTraverse([](auto& data) 
-                {
-                    cout << data <<endl;
-                });
+    else if (name == "traverse")
+    {
+        size_t pre = reply.numbers[0];
+        size_t in = pre + reply.numbers[1];
+        out<<"Pre-Order Traversal "<<endl;
+        for (size_t i = 0; i < pre; i++)
+            out<<reply.words[i]<<endl;
+        out<<"In-Order Traversal "<<endl;
+        for (size_t i = pre; i < in; i++)
+            out<<reply.words[i]<<endl;
+        out<<"Post-Order Traversal "<<endl;
+        for (size_t i = in; i < reply.words.size(); i++)
+            out<<reply.words[i]<<endl;
     } 
-    
-    else if (command == "gen")
+    else if (name == "gen")
     {
-        int ancestors;
-        string parent;
-        string parameter;
-        iss >> parameter;
-
-        cout<<"Geneology = ";
-        if (Tree.inTree(parameter) == false)
+        out<<"Geneology = ";
+        if (!reply.found)
         {
-            cout<<parameter<<" UNDEFINED"<<endl;
+            out<<parameter<<" UNDEFINED"<<endl;
         }
-        
         else
         {
-            cout<<parameter<<endl;
-            if(Tree.getParent(parameter)==nullptr)
-        {
-            parent="NULL";
+            out<<parameter<<endl;
+            out<<"Parent = "<<reply.words[0]<<", ";
+            out<<"Left Child: "<<reply.words[1]<<", Right Child: "<<reply.words[2]<<endl;
+            out<<"#ancestors = "<<reply.numbers[0];
+            out<<", #descendants="<<reply.numbers[1]<<endl;
         }
-        
-        else 
-        {
-            parent=*Tree.getParent(parameter);
-        }
-        
-        cout<<"Parent = "<<parent<<", ";
-       
-    vector<string*> children = Tree.getChildren(parameter);
-    
-    // Access the elements in the vector
-    cout<<"Left Child: "; 
-    if (children[0] != nullptr)
+    }
+    else if (name == "props") 
     {
-        cout<<*children[0];
+        out<<"Properties:"<<endl;
+        out<<"Size = "<<reply.numbers[0]<<", Height = "<<reply.numbers[1]
+           <<", Diameter = "<<reply.numbers[2]<<endl;
+        out<<"Fibonnaci? = "<<(reply.numbers[3] ? "True" : "False");
+        out<<", Complete? = "<<(reply.numbers[4] ? "True" : "False")<<endl;
     } 
-    else 
+    else if (name == "mem")
     {
-        cout << "None";
+        out<<"Memory:"<<endl;
+        out<<"Nodes = "<<reply.numbers[0]<<", Node Bytes = "<<reply.numbers[1]
+           <<", Key Bytes = "<<reply.numbers[2]<<", Allocator Bytes = "<<reply.numbers[3]
+           <<", Total = "<<reply.numbers[4]<<endl;
     }
-    
-    cout<<", Right Child: ";
-    if (children[1] != nullptr) 
-    {
-        cout<<*children[1];
-    } 
-    else 
+    return true;
+}
+
+/**
+ * Replays a command file against a tree
+ * @param Tree the tree
+ * @param filename the name of the command file
+ * @param normalize the normalizer for the order of the tree
+ * @param quiet indicates whether the normal command output is suppressed
+ * @param profiling indicates whether command latencies are reported
+ */
+template <typename T>
+void replay(T& Tree, const string& filename, const KeyNormalizer& normalize, bool quiet, bool profiling)
+{
+    ifstream txtFile(filename);
+    string line;
+    ostream out(quiet ? nullptr : cout.rdbuf());
+    map<string, LatencyHistogram> profile;
+    auto replayStart = chrono::steady_clock::now();
+
+    while (getline(txtFile, line))
     {
-        cout << "None";
+        Command command = parse(line, normalize);
+        /* only execution is timed, as in pipeline(), so that the two
+           histograms measure the same thing */
+        auto commandStart = chrono::steady_clock::now();
+        Reply reply = execute(Tree, command);
+        auto commandEnd = chrono::steady_clock::now();
+        if (!format(out, reply))
+            continue;
+        if (profiling)
+            profile[command.name].record(chrono::duration_cast<chrono::nanoseconds>(
+                commandEnd - commandStart).count());
     }
-    cout<<endl;
 
-        ancestors=Tree.ancestors(parameter);
-        cout<<"#ancestors = "<<ancestors;
-        
-        int descendant;
-        descendant=Tree.descendants(parameter);
-        cout<<", #descendants="<<descendant<<endl;
+    if (profiling)
+        printProfile(cerr, profile, chrono::steady_clock::now() - replayStart);
+}
 
-    }} 
-    else if (command == "props") 
+/**
+ * Replays a command file against a tree on three threads: one parses the
+ * lines, one executes the commands against the tree and one prints their
+ * output, each passing its work to the next through a bounded queue. The
+ * output is the same, in the same order, as that of replay().
+ * @param Tree the tree
+ * @param filename the name of the command file
+ * @param normalize the normalizer for the order of the tree
+ * @param quiet indicates whether the normal command output is suppressed
+ * @param profiling indicates whether command latencies and the
+ * utilization of each stage are reported
+ */
+template <typename T>
+void pipeline(T& Tree, const string& filename, const KeyNormalizer& normalize, bool quiet, bool profiling)
+{
+    const size_t DEPTH = 1024;
+    SpscQueue<Command> commands(DEPTH);
+    SpscQueue<Reply> replies(DEPTH);
+    map<string, LatencyHistogram> profile;
+    uint64_t parsed = 0;
+    auto replayStart = chrono::steady_clock::now();
+    chrono::steady_clock::time_point parseEnd, executeEnd;
+
+    thread parser([&]()
     {
-        cout<<"Properties:"<<endl;
-        cout<<"Size = "<<Tree.size()<<", Height = "<<Tree.height()<<", Diameter = "<<Tree.diameter()<<endl;
-        cout<<"Fibonnaci? = ";
-        if(Tree.isFibonacci() == 1)
+        ifstream txtFile(filename);
+        string line;
+        while (getline(txtFile, line))
         {
-            cout<<"True";
+            commands.push(parse(line, normalize));
+            parsed++;
         }
-        
-        else
-        {
-            cout<<"False";
-        }
-        
-        cout<<", Complete? = ";
-        if(Tree.isComplete() == 1)
+        commands.close();
+        parseEnd = chrono::steady_clock::now();
+    });
+    thread executor([&]()
+    {
+        Command command;
+        while (commands.pop(command))
         {
-            cout<<"True";
+            auto commandStart = chrono::steady_clock::now();
+            Reply reply = execute(Tree, command);
+            if (profiling && reply.known)
+                profile[command.name].record(chrono::duration_cast<chrono::nanoseconds>(
+                    chrono::steady_clock::now() - commandStart).count());
+            replies.push(std::move(reply));
         }
-        
-        else
-    
+        replies.close();
+        executeEnd = chrono::steady_clock::now();
+    });
+
+    ostream out(quiet ? nullptr : cout.rdbuf());
+    Reply reply;
+    while (replies.pop(reply))
+        format(out, reply);
+    auto formatEnd = chrono::steady_clock::now();
+    parser.join();
+    executor.join();
+
+    if (profiling)
+    {
+        auto elapsed = formatEnd - replayStart;
+        printProfile(cerr, profile, elapsed);
+        /* a stage is busy whenever it is not waiting on one of its queues */
+        auto span = [&replayStart](chrono::steady_clock::time_point end)
         {
-            cout<<"False";
-        }
-        cout<<endl;
+            return (double)chrono::duration_cast<chrono::nanoseconds>(end - replayStart).count();
+        };
+        double busy[] = {span(parseEnd) - commands.producerWaiting(),
+                         span(executeEnd) - commands.consumerWaiting() - replies.producerWaiting(),
+                         span(formatEnd) - replies.consumerWaiting()};
+        const char* stages[] = {"parse", "execute", "format"};
+        double wall = span(formatEnd);
+        cerr<<"Pipeline: "<<parsed<<" lines, queue depth "<<DEPTH<<endl;
+        cerr<<left<<setw(10)<<"stage"<<right<<setw(12)<<"busy(s)"<<setw(12)<<"util(%)"<<endl;
+        for (int i = 0; i < 3; i++)
+            cerr<<left<<setw(10)<<stages[i]<<right<<fixed<<setprecision(6)<<setw(12)
+                <<busy[i] / 1e9<<setprecision(1)<<setw(12)<<100 * busy[i] / wall<<endl;
+    }
+}
 
-    } 
-    else 
+int main(int argc, char** argv) 
+{
+    string usage = "Dendrologist [--profile] [--quiet] [--pipeline] [--balance avl|wavl|rb] <order-code> <command-file>\n";
+    usage += "  <order-code>:\n";
+    usage += "  0 ordered by increasing string length, primary key, and reverse lexicographical order, secondary key\n";
+    usage += "  -1 for reverse lexicographical order\n";
+    usage += "  1 for lexicographical order\n";
+    usage += "  -2 ordered by decreasing string length\n";
+    usage += "  2 ordered by increasing string length\n";
+    usage += "  -3 ordered by decreasing string length, primary key, and reverse lexicographical order, secondary key\n";
+    usage += "  3 ordered by increasing string length, primary key, and lexicographical order, secondary key\n";  
+    usage += "  --profile: report per-command execution latency percentiles and throughput on stderr\n";
+    usage += "  --quiet: suppress the normal command output\n";
+    usage += "  --pipeline: parse, execute and print on three threads; with --profile, also report the utilization of each\n";
+    usage += "  --balance: the balancing policy of the tree, AVL (the default), weak AVL or red-black\n";
+    usage += "  <command-file> commands, one per line:\n";
+    usage += "  insert <key>, delete <key>, traverse, gen <key> (parent, children, ancestors and descendants),\n";
+    usage += "  props (size, height, diameter, Fibonacci and complete) and mem (node, key and allocator bytes)\n";
+    bool profiling = false;
+    bool quiet = false;
+    bool pipelined = false;
+    string balance = "avl";
+    vector<string> args;
+    for (int i = 1; i < argc; i++)
     {
-        cerr << "Unknown command: " << command << endl;
+        string arg = argv[i];
+        if (arg == "--profile")
+            profiling = true;
+        else if (arg == "--quiet")
+            quiet = true;
+        else if (arg == "--pipeline")
+            pipelined = true;
+        else if (arg == "--balance" && i + 1 < argc)
+            balance = argv[++i];
+        else
+            args.push_back(arg);
     }
+    if (args.size() != 2 || (balance != "avl" && balance != "wavl" && balance != "rb"))
+    {
+        cout<<usage<<endl;
+        throw invalid_argument("There should be 3 command line arguments.");
+    }
+    
+    int sortCode = stoi(args[0]);
+    string filename = args[1];
+/* each order is a length key and a text key folded into one byte string,
+   so that every order code compares keys with a single memcmp */
+KeyNormalizer normalize;
+switch (sortCode) {
+        case -3:
+            normalize = KeyNormalizer(-1, -1);
+            break;
+        case -2:
+            normalize = KeyNormalizer(-1, 0);
+            break;
+        case -1:
+            normalize = KeyNormalizer(0, -1);
+            break;
+        case 0:
+            normalize = KeyNormalizer(1, -1);
+            break;
+        case 1:
+            normalize = KeyNormalizer(0, 1);
+            break;
+        case 2:
+            normalize = KeyNormalizer(1, 0);
+            break;
+        case 3:
+            normalize = KeyNormalizer(1, 1);
+            break;
+        default:
+            cout << "Invalid sortcode" << endl;
+            break;
     }
 
+auto run = [&](auto& Tree)
+{
+    if (pipelined)
+        pipeline(Tree, filename, normalize, quiet, profiling);
+    else
+        replay(Tree, filename, normalize, quiet, profiling);
+};
+
+if (balance == "avl")
+{
+    AVLTree<NormalizedKey> Tree;
+    run(Tree);
+}
+else if (balance == "wavl")
+{
+    AVLTree<NormalizedKey, NoAugment, WAVLBalance> Tree;
+    run(Tree);
+}
+else
+{
+    AVLTree<NormalizedKey, NoAugment, RedBlackBalance> Tree;
+    run(Tree);
+}
     return 0;
 }
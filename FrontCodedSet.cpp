@@ -0,0 +1,165 @@
+/**
+ * Models a frozen ordered set of strings kept front-coded.
+ * @author William Duncan, Cody Carter
+ * @see FrontCodedSet
+ * <pre>
+ * Date: 10/18/2023
+ * </pre>
+ */
+#ifndef FRONTCODEDSET_CPP
+#define FRONTCODEDSET_CPP
+
+#include "FrontCodedSet.h"
+#include "AVLTree.cpp"
+
+using namespace std;
+
+inline FrontCodedSet::FrontCodedSet()
+{
+   keyCount = 0;
+   natural = true;
+}
+
+template <typename T>
+FrontCodedSet::FrontCodedSet(T& tree, std::function<int(const string&, const string&)> fn)
+{
+   keyCount = 0;
+   natural = !fn;
+   cmp = fn;
+   string previous;
+   tree.traverse([&](const auto& item)
+      {
+         string_view key = keyText(item);
+         bool first = keyCount % BLOCK_SIZE == 0;
+         if (first)
+            blocks.push_back(bytes.size());
+         append(key, previous, first);
+         previous.assign(key.data(), key.size());
+         keyCount++;
+      });
+   bytes.shrink_to_fit();
+   blocks.shrink_to_fit();
+}
+
+inline bool FrontCodedSet::isEmpty() const
+{
+   return keyCount == 0;
+}
+
+inline bool FrontCodedSet::inTree(const string& item) const
+{
+   /* find the last block whose first key does not follow the item */
+   size_t lo = 0;
+   size_t hi = blocks.size();
+   while (lo < hi)
+   {
+      size_t mid = (lo + hi) / 2;
+      if (compare(item, head(mid)) < 0)
+         hi = mid;
+      else
+         lo = mid + 1;
+   }
+   if (lo == 0)
+      return false;
+   size_t block = lo - 1;
+   size_t at = blocks[block];
+   size_t last = block + 1 < blocks.size() ? blocks[block + 1] : bytes.size();
+   string key;
+   size_t length = readLength(at);
+   key.assign(bytes.data() + at, length);
+   at += length;
+   while (true)
+   {
+      int diff = compare(item, key);
+      if (diff <= 0)
+         return diff == 0;
+      if (at == last)
+         return false;
+      size_t shared = readLength(at);
+      size_t rest = readLength(at);
+      key.resize(shared);
+      key.append(bytes.data() + at, rest);
+      at += rest;
+   }
+}
+
+inline void FrontCodedSet::traverse(FuncType func) const
+{
+   string key;
+   size_t at = 0;
+   for (size_t i = 0; i < keyCount; i++)
+   {
+      size_t shared = i % BLOCK_SIZE == 0 ? 0 : readLength(at);
+      size_t rest = readLength(at);
+      key.resize(shared);
+      key.append(bytes.data() + at, rest);
+      at += rest;
+      func(key);
+   }
+}
+
+inline int FrontCodedSet::size() const
+{
+   return keyCount;
+}
+
+inline size_t FrontCodedSet::memoryBytes() const
+{
+   return bytes.capacity() + blocks.capacity() * sizeof(uint32_t);
+}
+
+/* Private functions */
+
+inline void FrontCodedSet::writeLength(size_t value)
+{
+   while (value >= 128)
+   {
+      bytes.push_back((char)((value & 127) | 128));
+      value >>= 7;
+   }
+   bytes.push_back((char)value);
+}
+
+inline size_t FrontCodedSet::readLength(size_t& at) const
+{
+   size_t value = 0;
+   for (int shift = 0; ; shift += 7)
+   {
+      unsigned char part = bytes[at++];
+      value |= (size_t)(part & 127) << shift;
+      if (part < 128)
+         return value;
+   }
+}
+
+inline void FrontCodedSet::append(string_view key, string_view previous, bool first)
+{
+   /* the decoders expect a shared length for every key but the first of
+      a block, even when the key before it is empty */
+   size_t shared = 0;
+   if (!first)
+   {
+      while (shared < key.size() && shared < previous.size() && key[shared] == previous[shared])
+         shared++;
+      writeLength(shared);
+   }
+   writeLength(key.size() - shared);
+   bytes.insert(bytes.end(), key.begin() + shared, key.end());
+}
+
+inline int FrontCodedSet::compare(const string& item, string_view key) const
+{
+   if (natural)
+      return string_view(item).compare(key);
+   return cmp(item, string(key));
+}
+
+inline string_view FrontCodedSet::head(size_t block) const
+{
+   size_t at = blocks[block];
+   size_t length = readLength(at);
+   return string_view(bytes.data() + at, length);
+}
+
+//FRONTCODEDSET_CPP
+#endif
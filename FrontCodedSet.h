@@ -0,0 +1,182 @@
+/**
+ * Models a frozen ordered set of strings kept front-coded
+ * @author William Duncan, Cody Carter
+ * <pre>
+ * File: FrontCodedSet.h
+ * Date: 10/18/2023
+ * </pre>
+ */
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include "AVLTree.h"
+
+#ifndef FRONTCODEDSET_H
+#define FRONTCODEDSET_H
+
+using namespace std;
+
+/**
+ * Gives the characters of a string key
+ * @param item a string
+ * @return a view of its characters
+ */
+inline string_view keyText(const string& item)
+{
+   return item;
+}
+
+/**
+ * Gives the characters of an arena string
+ * @param item an arena string
+ * @return a view of its characters
+ */
+inline string_view keyText(const ArenaString& item)
+{
+   return item.view();
+}
+
+/**
+ * Gives the original text of a normalized key
+ * @param item a normalized key
+ * @return a view of its text
+ */
+inline string_view keyText(const NormalizedKey& item)
+{
+   return item.text;
+}
+
+/**
+ * Describes a read-only snapshot of the keys of a string tree, in the
+ * order of the tree. The keys are stored front-coded in blocks of
+ * BLOCK_SIZE: the first key of a block in full, every other key as the
+ * length of the prefix it shares with the key before it and the rest of
+ * its characters. In-order neighbours share long prefixes in most
+ * dictionaries, so the set takes a fraction of the bytes of the tree. A
+ * search binary-searches the first keys of the blocks and decodes one
+ * block.
+ * @see AVLTree
+ */
+class FrontCodedSet
+{
+private:
+   typedef std::function<void(const string&)> FuncType;
+   /**
+    * the number of keys in a block
+    */
+   static const int BLOCK_SIZE = 16;
+
+   /**
+    * the encoded blocks, one after another; lengths are LEB128 varints
+    */
+   vector<char> bytes;
+   /**
+    * the offset of each block in the encoding
+    */
+   vector<uint32_t> blocks;
+   /**
+    * the number of keys in the set
+    */
+   size_t keyCount;
+   /**
+    * indicates whether the keys are in lexicographical order, in which
+    * case they are compared in place without being copied
+    */
+   bool natural;
+   /**
+    * A trichotomous integer-value comparator function
+    */
+   std::function<int(const string&, const string&)> cmp;
+
+   /**
+    * Appends a varint to the encoding
+    * @param value the value to append
+    */
+   void writeLength(size_t value);
+
+   /**
+    * Reads a varint of the encoding
+    * @param at the offset of the varint; advanced past it
+    * @return the value of the varint
+    */
+   size_t readLength(size_t& at) const;
+
+   /**
+    * Appends a key to the encoding
+    * @param key the key
+    * @param previous the key before it; ignored for the first key of a
+    * block
+    * @param first whether the key is the first of its block, which is
+    * written in full
+    */
+   void append(string_view key, string_view previous, bool first);
+
+   /**
+    * Compares a search key with a key of the set
+    * @param item the search key
+    * @param key a key of the set
+    * @return a negative integer when item precedes key; 0 when they are
+    * equal; otherwise, a positive integer
+    */
+   int compare(const string& item, string_view key) const;
+
+   /**
+    * Gives the first key of a block, in place
+    * @param block the index of a block
+    * @return a view of the first key of the block
+    */
+   string_view head(size_t block) const;
+public:
+   /**
+    * Constructs an empty set in lexicographical order
+    */
+   FrontCodedSet();
+
+   /**
+    * Constructs a snapshot of the keys of a tree
+    * @param tree a tree of strings, arena strings or normalized keys
+    * @param fn - an integer-value binary comparator function agreeing with
+    * the order of the tree on the text of the keys; lexicographical order
+    * when null
+    */
+   template <typename T>
+   FrontCodedSet(T& tree, std::function<int(const string&, const string&)> fn = nullptr);
+
+   /**
+    * Determine whether the set is empty.
+    * @return true if the set is empty; otherwise, false
+    */
+   bool isEmpty() const;
+
+   /**
+    * Determine whether an item is in the set.
+    * @param item item with a specified search key.
+    * @return true on success; false on failure.
+    */
+   bool inTree(const string& item) const;
+
+   /**
+    * This function traverses the set in order and calls the function
+    * Visit once for each key.
+    * @param func the function to apply to each key
+    */
+   void traverse(FuncType func) const;
+
+   /**
+    * Returns the number of keys in the set.
+    * @return the number of keys in the set.
+    */
+   int size() const;
+
+   /**
+    * Gives the memory taken by the set
+    * @return the bytes of the encoding and of the block index
+    */
+   size_t memoryBytes() const;
+};
+
+//FRONTCODEDSET_H
+#endif
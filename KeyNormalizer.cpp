@@ -0,0 +1,54 @@
+/**
+ * Models string keys encoded for comparison by memcmp.
+ * @author William Duncan, Cody Carter
+ * @see KeyNormalizer
+ * <pre>
+ * Date: 10/18/2023
+ * </pre>
+ */
+#ifndef KEYNORMALIZER_CPP
+#define KEYNORMALIZER_CPP
+
+#include "KeyNormalizer.h"
+
+using namespace std;
+
+inline KeyNormalizer::KeyNormalizer(int byLength, int byText) : lengthOrder(byLength), textOrder(byText)
+{
+}
+
+inline NormalizedKey KeyNormalizer::operator()(const string& text) const
+{
+   NormalizedKey key;
+   key.text = text;
+   string& out = key.bytes;
+   out.reserve(text.size() + 11);
+   if (lengthOrder != 0)
+   {
+      unsigned char flip = lengthOrder < 0 ? 0xFF : 0;
+      size_t length = text.size();
+      int width = 0;
+      for (size_t rest = length; rest > 0; rest >>= 8)
+         width++;
+      out.push_back((char)(width ^ flip));
+      for (int i = width - 1; i >= 0; i--)
+         out.push_back((char)(((length >> (8 * i)) & 0xFF) ^ flip));
+   }
+   if (textOrder > 0)
+      out += text;
+   else if (textOrder < 0)
+   {
+      for (unsigned char c : text)
+      {
+         out.push_back((char)~c);
+         if (c == 0)
+            out.push_back(0);
+      }
+      out.push_back((char)0xFF);
+      out.push_back((char)0xFF);
+   }
+   return key;
+}
+
+//KEYNORMALIZER_CPP
+#endif
@@ -0,0 +1,123 @@
+/**
+ * Models string keys encoded for comparison by memcmp
+ * @author William Duncan, Cody Carter
+ * <pre>
+ * File: KeyNormalizer.h
+ * Date: 10/18/2023
+ * </pre>
+ */
+
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+
+#ifndef KEYNORMALIZER_H
+#define KEYNORMALIZER_H
+
+using namespace std;
+
+/**
+ * A string key paired with a byte encoding of it whose plain memcmp order,
+ * shorter encodings first on a tie, is the order the key was normalized
+ * for. Trees of normalized keys compare every key with a single memcmp
+ * whatever the order, and print the original text.
+ * @see KeyNormalizer
+ */
+struct NormalizedKey
+{
+   /**
+    * the order-preserving encoding of the key
+    */
+   string bytes;
+   /**
+    * the key as it was given
+    */
+   string text;
+};
+
+/**
+ * Compares two normalized keys by their encodings
+ * @param a a normalized key
+ * @param b another normalized key
+ * @return a negative integer when a precedes b; 0 when they are equal;
+ * otherwise, a positive integer
+ */
+inline int naturalOrder(const NormalizedKey& a, const NormalizedKey& b)
+{
+   size_t shorter = a.bytes.size() < b.bytes.size() ? a.bytes.size() : b.bytes.size();
+   int diff = memcmp(a.bytes.data(), b.bytes.data(), shorter);
+   if (diff != 0)
+      return diff;
+   return (a.bytes.size() > b.bytes.size()) - (a.bytes.size() < b.bytes.size());
+}
+
+inline bool operator<(const NormalizedKey& a, const NormalizedKey& b)
+{
+   return naturalOrder(a, b) < 0;
+}
+
+inline bool operator==(const NormalizedKey& a, const NormalizedKey& b)
+{
+   return a.bytes == b.bytes;
+}
+
+inline ostream& operator<<(ostream& os, const NormalizedKey& key)
+{
+   return os << key.text;
+}
+
+/**
+ * Encodes strings as normalized keys for an order made of an optional
+ * length key followed by an optional text key. The length is written as
+ * its byte count then its bytes, most significant first, so that longer
+ * strings encode larger; the text is written as is for lexicographical
+ * order. For reverse lexicographical order every byte is complemented and
+ * the text closed by 0xFF 0xFF, a zero byte being written as 0xFF 0x00,
+ * so that a string sorts after every string it is a prefix of. A
+ * decreasing length complements the length bytes.
+ */
+class KeyNormalizer
+{
+private:
+   /**
+    * 1 for increasing length, -1 for decreasing length, 0 to ignore it
+    */
+   int lengthOrder;
+   /**
+    * 1 for lexicographical order, -1 for reverse lexicographical order,
+    * 0 to ignore the text
+    */
+   int textOrder;
+public:
+   /**
+    * Constructs a normalizer for the specified order
+    * @param byLength 1 to order by increasing length, -1 by decreasing
+    * length and 0 to ignore the length; the length, when used, is the
+    * primary key
+    * @param byText 1 to order by lexicographical order, -1 by reverse
+    * lexicographical order and 0 to ignore the text
+    */
+   KeyNormalizer(int byLength = 0, int byText = 1);
+
+   /**
+    * Normalizes a string
+    * @param text a string
+    * @return the string with its encoding
+    */
+   NormalizedKey operator()(const string& text) const;
+};
+
+/**
+ * Gives the hash of a normalized key: that of its encoding, which is
+ * what it is compared by
+ * @param item a normalized key
+ * @return the hash of the encoding
+ */
+inline size_t keyHash(const NormalizedKey& item)
+{
+   return std::hash<string>()(item.bytes);
+}
+
+//KEYNORMALIZER_H
+#endif
@@ -0,0 +1,473 @@
+/**
+ * Models an ordered set kept in a memory-mapped file.
+ * @param <E> data type of the tree
+ * @author William Duncan, Cody Carter
+ * @see MappedAVLTree
+ * <pre>
+ * Date: 10/18/2023
+ * </pre>
+ */
+#ifndef MAPPEDAVLTREE_CPP
+#define MAPPEDAVLTREE_CPP
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "MappedAVLTree.h"
+#include "AVLTree.cpp"
+
+using namespace std;
+
+template <typename E>
+MappedAVLTree<E>::MappedAVLTree(const string& filename)
+   : MappedAVLTree(filename, [](const E& a, const E& b) -> int{return naturalOrder(a, b);})
+{
+   natural = true;
+}
+
+template <typename E>
+MappedAVLTree<E>::MappedAVLTree(const string& filename, std::function<int(const E&, const E&)> fn)
+{
+   path = filename;
+   natural = false;
+   cmp = fn;
+   base = NULL;
+   fd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+   if (fd < 0)
+      throw AVLTreeException("AVL Tree Exception: cannot open " + filename);
+   struct stat info;
+   if (fstat(fd, &info) != 0)
+   {
+      close(fd);
+      throw AVLTreeException("AVL Tree Exception: cannot read the size of " + filename);
+   }
+   capacity = info.st_size;
+   if (capacity == 0)
+   {
+      try
+      {
+         grow(INITIAL_SIZE);
+      }
+      catch (...)
+      {
+         close(fd);
+         throw;
+      }
+      Header* head = header();
+      memset(head, 0, sizeof(Header));
+      head->magic = MAGIC;
+      head->width = MappedKey<E>::WIDTH;
+      head->end = (sizeof(Header) + 63) / 64 * 64;
+      return;
+   }
+   if (capacity < sizeof(Header))
+   {
+      close(fd);
+      throw AVLTreeException("AVL Tree Exception: " + filename + " is not a tree file");
+   }
+   try
+   {
+      map();
+   }
+   catch (...)
+   {
+      close(fd);
+      throw;
+   }
+   if (header()->magic != MAGIC || header()->width != MappedKey<E>::WIDTH)
+   {
+      munmap(base, capacity);
+      close(fd);
+      throw AVLTreeException("AVL Tree Exception: " + filename + " is not a tree file of this element type");
+   }
+}
+
+template <typename E>
+MappedAVLTree<E>::~MappedAVLTree()
+{
+   munmap(base, capacity);
+   close(fd);
+}
+
+template <typename E>
+bool MappedAVLTree<E>::isEmpty() const
+{
+   return header()->root == 0;
+}
+
+template <typename E>
+void MappedAVLTree<E>::insert(const E& obj)
+{
+   uint64_t root = insert(header()->root, obj);
+   header()->root = root;
+}
+
+template <typename E>
+bool MappedAVLTree<E>::inTree(const E& item) const
+{
+   uint64_t node = header()->root;
+   while (node != 0)
+   {
+      int diff = compareAt(item, node);
+      if (diff == 0)
+         return true;
+      node = diff < 0 ? at(node)->left : at(node)->right;
+   }
+   return false;
+}
+
+template <typename E>
+void MappedAVLTree<E>::remove(const E& item)
+{
+   uint64_t root = remove(header()->root, item);
+   header()->root = root;
+}
+
+template <typename E>
+E MappedAVLTree<E>::retrieve(const E& key) const
+{
+   if (isEmpty())
+      throw AVLTreeException("AVL Tree Exception: tree empty on retrieve()");
+   uint64_t node = header()->root;
+   while (node != 0)
+   {
+      int diff = compareAt(key, node);
+      if (diff == 0)
+         return keyAt(node);
+      node = diff < 0 ? at(node)->left : at(node)->right;
+   }
+   throw AVLTreeException("AVL Tree Exception: key not in tree call to retrieve()");
+}
+
+template <typename E>
+void MappedAVLTree<E>::traverse(FuncType func) const
+{
+   vector<uint64_t> stack;
+   uint64_t node = header()->root;
+   while (node != 0 || !stack.empty())
+   {
+      for (; node != 0; node = at(node)->left)
+         stack.push_back(node);
+      node = stack.back();
+      stack.pop_back();
+      func(keyAt(node));
+      node = at(node)->right;
+   }
+}
+
+template <typename E>
+void MappedAVLTree<E>::traverseBetween(const E& lo, const E& hi, FuncType func) const
+{
+   /* the stack holds the nodes not below lo whose right subtrees are
+      still to be visited; subtrees wholly below lo are never entered */
+   vector<uint64_t> stack;
+   uint64_t node = header()->root;
+   while (node != 0 || !stack.empty())
+   {
+      while (node != 0)
+      {
+         if (compareAt(lo, node) > 0)
+            node = at(node)->right;
+         else
+         {
+            stack.push_back(node);
+            node = at(node)->left;
+         }
+      }
+      node = stack.back();
+      stack.pop_back();
+      if (compareAt(hi, node) < 0)
+         return;
+      func(keyAt(node));
+      node = at(node)->right;
+   }
+}
+
+template <typename E>
+int MappedAVLTree<E>::size() const
+{
+   return header()->count;
+}
+
+template <typename E>
+int MappedAVLTree<E>::height() const
+{
+   return heightOf(header()->root);
+}
+
+template <typename E>
+uint64_t MappedAVLTree<E>::fileSize() const
+{
+   return capacity;
+}
+
+template <typename E>
+void MappedAVLTree<E>::sync()
+{
+   if (msync(base, capacity, MS_SYNC) != 0 || fsync(fd) != 0)
+      throw AVLTreeException("AVL Tree Exception: cannot write " + path);
+}
+
+/* Private functions */
+
+template <typename E>
+void MappedAVLTree<E>::map()
+{
+   void* mapping = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   if (mapping == MAP_FAILED)
+   {
+      base = NULL;
+      throw AVLTreeException("AVL Tree Exception: cannot map " + path);
+   }
+   base = static_cast<char*>(mapping);
+}
+
+template <typename E>
+void MappedAVLTree<E>::grow(uint64_t needed)
+{
+   uint64_t size = INITIAL_SIZE;
+   if (size < capacity)
+      size = capacity;
+   while (size < needed)
+      size *= 2;
+   if (ftruncate(fd, size) != 0)
+      throw AVLTreeException("AVL Tree Exception: cannot grow " + path);
+   if (base != NULL)
+      munmap(base, capacity);
+   capacity = size;
+   map();
+}
+
+template <typename E>
+uint64_t MappedAVLTree<E>::allocate(uint64_t bytes)
+{
+   bytes = (bytes + 7) / 8 * 8;
+   uint64_t offset = header()->end;
+   if (offset + bytes > capacity)
+      grow(offset + bytes);
+   header()->end = offset + bytes;
+   return offset;
+}
+
+template <typename E>
+int MappedAVLTree<E>::sizeClass(uint64_t length)
+{
+   int index = 0;
+   while ((uint64_t)16 << index < length)
+      index++;
+   return index;
+}
+
+template <typename E>
+uint64_t MappedAVLTree<E>::allocateKey(uint64_t length)
+{
+   int index = sizeClass(length);
+   uint64_t key = header()->freeKeys[index];
+   if (key != 0)
+      memcpy(&header()->freeKeys[index], base + key, sizeof(uint64_t));
+   else
+      key = allocate((uint64_t)16 << index);
+   return key;
+}
+
+template <typename E>
+void MappedAVLTree<E>::freeKey(uint64_t key, uint64_t length)
+{
+   int index = sizeClass(length);
+   memcpy(base + key, &header()->freeKeys[index], sizeof(uint64_t));
+   header()->freeKeys[index] = key;
+}
+
+template <typename E>
+void MappedAVLTree<E>::setKey(uint64_t node, const E& obj)
+{
+   uint64_t length = MappedKey<E>::size(obj);
+   uint64_t key = at(node)->key;
+   if (sizeClass(length) != sizeClass(at(node)->keyLength))
+   {
+      freeKey(key, at(node)->keyLength);
+      key = allocateKey(length);
+   }
+   /* the allocation may have moved the mapping */
+   MappedKey<E>::write(obj, base + key);
+   at(node)->key = key;
+   at(node)->keyLength = length;
+}
+
+template <typename E>
+uint64_t MappedAVLTree<E>::createNode(const E& obj)
+{
+   uint64_t length = MappedKey<E>::size(obj);
+   uint64_t key = allocateKey(length);
+   uint64_t node = header()->freeNodes;
+   if (node != 0)
+      header()->freeNodes = at(node)->left;
+   else
+      node = allocate(sizeof(Node));
+   /* both allocations are done, so the addresses below stay put */
+   MappedKey<E>::write(obj, base + key);
+   Node* fresh = at(node);
+   fresh->left = 0;
+   fresh->right = 0;
+   fresh->key = key;
+   fresh->keyLength = length;
+   fresh->height = 0;
+   header()->count++;
+   return node;
+}
+
+template <typename E>
+void MappedAVLTree<E>::freeNode(uint64_t node)
+{
+   freeKey(at(node)->key, at(node)->keyLength);
+   Node* dead = at(node);
+   dead->left = header()->freeNodes;
+   header()->freeNodes = node;
+   header()->count--;
+}
+
+template <typename E>
+int MappedAVLTree<E>::compareAt(const E& item, uint64_t node) const
+{
+   const Node* stored = at(node);
+   if (natural)
+      return MappedKey<E>::compare(item, base + stored->key, stored->keyLength);
+   return cmp(item, MappedKey<E>::read(base + stored->key, stored->keyLength));
+}
+
+template <typename E>
+E MappedAVLTree<E>::keyAt(uint64_t node) const
+{
+   const Node* stored = at(node);
+   return MappedKey<E>::read(base + stored->key, stored->keyLength);
+}
+
+template <typename E>
+int MappedAVLTree<E>::heightOf(uint64_t node) const
+{
+   return node == 0 ? -1 : at(node)->height;
+}
+
+template <typename E>
+void MappedAVLTree<E>::update(uint64_t node)
+{
+   int left = heightOf(at(node)->left);
+   int right = heightOf(at(node)->right);
+   at(node)->height = (left > right ? left : right) + 1;
+}
+
+template <typename E>
+uint64_t MappedAVLTree<E>::rotateLeft(uint64_t node)
+{
+   uint64_t child = at(node)->right;
+   at(node)->right = at(child)->left;
+   at(child)->left = node;
+   update(node);
+   update(child);
+   return child;
+}
+
+template <typename E>
+uint64_t MappedAVLTree<E>::rotateRight(uint64_t node)
+{
+   uint64_t child = at(node)->left;
+   at(node)->left = at(child)->right;
+   at(child)->right = node;
+   update(node);
+   update(child);
+   return child;
+}
+
+template <typename E>
+uint64_t MappedAVLTree<E>::rebalance(uint64_t node)
+{
+   update(node);
+   int balance = heightOf(at(node)->right) - heightOf(at(node)->left);
+   if (balance > 1)
+   {
+      uint64_t child = at(node)->right;
+      if (heightOf(at(child)->left) > heightOf(at(child)->right))
+         at(node)->right = rotateRight(child);
+      return rotateLeft(node);
+   }
+   if (balance < -1)
+   {
+      uint64_t child = at(node)->left;
+      if (heightOf(at(child)->right) > heightOf(at(child)->left))
+         at(node)->left = rotateLeft(child);
+      return rotateRight(node);
+   }
+   return node;
+}
+
+template <typename E>
+uint64_t MappedAVLTree<E>::insert(uint64_t node, const E& obj)
+{
+   if (node == 0)
+      return createNode(obj);
+   int diff = compareAt(obj, node);
+   if (diff == 0)
+   {
+      /* the new item replaces the stored one, as in AVLTree */
+      setKey(node, obj);
+      return node;
+   }
+   /* the recursive call may move the mapping: write through a fresh address */
+   if (diff < 0)
+   {
+      uint64_t child = insert(at(node)->left, obj);
+      at(node)->left = child;
+   }
+   else
+   {
+      uint64_t child = insert(at(node)->right, obj);
+      at(node)->right = child;
+   }
+   return rebalance(node);
+}
+
+template <typename E>
+uint64_t MappedAVLTree<E>::remove(uint64_t node, const E& item)
+{
+   if (node == 0)
+      return 0;
+   int diff = compareAt(item, node);
+   if (diff < 0)
+      at(node)->left = remove(at(node)->left, item);
+   else if (diff > 0)
+      at(node)->right = remove(at(node)->right, item);
+   else
+   {
+      Node* found = at(node);
+      uint64_t sub;
+      if (found->left == 0 || found->right == 0)
+         sub = found->left != 0 ? found->left : found->right;
+      else
+      {
+         /* the successor takes the place of the node */
+         uint64_t right = detachMin(found->right, sub);
+         at(sub)->left = found->left;
+         at(sub)->right = right;
+         sub = rebalance(sub);
+      }
+      freeNode(node);
+      return sub;
+   }
+   return rebalance(node);
+}
+
+template <typename E>
+uint64_t MappedAVLTree<E>::detachMin(uint64_t node, uint64_t& detached)
+{
+   if (at(node)->left == 0)
+   {
+      detached = node;
+      return at(node)->right;
+   }
+   at(node)->left = detachMin(at(node)->left, detached);
+   return rebalance(node);
+}
+
+//MAPPEDAVLTREE_CPP
+#endif
@@ -0,0 +1,514 @@
+/**
+ * Models an ordered set kept in a memory-mapped file
+ * @author William Duncan, Cody Carter
+ * <pre>
+ * File: MappedAVLTree.h
+ * Date: 10/18/2023
+ * </pre>
+ */
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include "AVLTree.h"
+
+#ifndef MAPPEDAVLTREE_H
+#define MAPPEDAVLTREE_H
+
+using namespace std;
+
+/**
+ * Describes how an element is stored in a mapped file: as a run of bytes
+ * that is written once when the element is inserted and read back when
+ * it is retrieved. Elements of this default are copied byte for byte, so
+ * they must be trivially copyable.
+ * @param <E> the data type
+ */
+template <typename E>
+struct MappedKey
+{
+   static_assert(std::is_trivially_copyable<E>::value,
+                 "a mapped tree stores elements that are trivially copyable, or strings");
+
+   /**
+    * the number of bytes of every element; 0 for elements of varying size
+    */
+   static const uint64_t WIDTH = sizeof(E);
+
+   /**
+    * Gives the number of bytes an element is stored in
+    * @param item an element
+    * @return the size of its stored form
+    */
+   static size_t size(const E& item)
+   {
+      return sizeof(E);
+   }
+
+   /**
+    * Writes the stored form of an element
+    * @param item an element
+    * @param bytes the place to write it; size(item) bytes long
+    */
+   static void write(const E& item, char* bytes)
+   {
+      memcpy(bytes, &item, sizeof(E));
+   }
+
+   /**
+    * Reads an element back from its stored form
+    * @param bytes the stored form
+    * @param length the size of the stored form
+    * @return the element
+    */
+   static E read(const char* bytes, size_t length)
+   {
+      E item;
+      memcpy(&item, bytes, sizeof(E));
+      return item;
+   }
+
+   /**
+    * Compares an element with a stored element by naturalOrder()
+    * @param item an element
+    * @param bytes the stored form of another element
+    * @param length the size of the stored form
+    * @return a negative integer when item precedes the stored element; 0
+    * when they are equal; otherwise, a positive integer
+    */
+   static int compare(const E& item, const char* bytes, size_t length)
+   {
+      return naturalOrder(item, read(bytes, length));
+   }
+};
+
+/**
+ * Strings are stored as their characters; they compare with the stored
+ * characters in place, without being read back
+ */
+template <>
+struct MappedKey<string>
+{
+   static const uint64_t WIDTH = 0;
+
+   static size_t size(const string& item)
+   {
+      return item.size();
+   }
+
+   static void write(const string& item, char* bytes)
+   {
+      memcpy(bytes, item.data(), item.size());
+   }
+
+   static string read(const char* bytes, size_t length)
+   {
+      return string(bytes, length);
+   }
+
+   static int compare(const string& item, const char* bytes, size_t length)
+   {
+      size_t shorter = item.size() < length ? item.size() : length;
+      int diff = memcmp(item.data(), bytes, shorter);
+      if (diff != 0)
+         return diff;
+      return (item.size() > length) - (item.size() < length);
+   }
+};
+
+/**
+ * Describes an ordered set whose AVL tree lives in a memory-mapped file.
+ * Nodes and keys refer to one another by their offsets in the file rather
+ * than by address, so a file can be opened and searched at once, with the
+ * operating system reading in only the pages a search touches, and the
+ * mapping can move when the file grows. Space is handed out by an
+ * allocator kept in the file: nodes and key blocks freed by deletions are
+ * chained on free lists and reused. Writes reach the file when the
+ * operating system flushes the mapping, or at once on sync(); the file is
+ * not kept consistent across a crash in the middle of a write.
+ * The order is not stored in the file: a file must be reopened with the
+ * comparator it was built with.
+ * This is a class of its own rather than a storage policy of AVLTree:
+ * AVLTree links its nodes by address throughout, holds its elements as
+ * C++ objects, and keeps balance factors, multiplicities, weights and
+ * aggregates that a file would have to store and version too. Its own
+ * small height-balanced insert and delete keep every address confined to
+ * at(), so the mapping can move underneath.
+ * @param <E> the data type; trivially copyable, or string
+ * @see AVLTree
+ * @see MappedKey
+ * @see AVLTreeException
+ */
+template <typename E>
+class MappedAVLTree
+{
+private:
+   typedef std::function<void(const E&)> FuncType;
+   /**
+    * identifies a mapped tree file: "AVLMAP01"
+    */
+   static const uint64_t MAGIC = 0x313050414d4c5641ULL;
+   /**
+    * the size of a new file
+    */
+   static const uint64_t INITIAL_SIZE = 1 << 16;
+   /**
+    * the number of free lists of key blocks; list i holds blocks of
+    * 16 << i bytes
+    */
+   static const int SIZE_CLASSES = 40;
+
+   /**
+    * The start of the file
+    */
+   struct Header
+   {
+      /**
+       * MAGIC
+       */
+      uint64_t magic;
+      /**
+       * the stored size of every element; 0 for elements of varying size
+       */
+      uint64_t width;
+      /**
+       * the offset of the root node; 0 when the tree is empty
+       */
+      uint64_t root;
+      /**
+       * the number of keys in the tree
+       */
+      uint64_t count;
+      /**
+       * the offset of the first byte never allocated
+       */
+      uint64_t end;
+      /**
+       * the first freed node
+       */
+      uint64_t freeNodes;
+      /**
+       * the first freed key block of each size class
+       */
+      uint64_t freeKeys[SIZE_CLASSES];
+   };
+
+   /**
+    * A node of the tree as stored in the file; offset 0 is the header, so
+    * 0 serves as the null offset
+    */
+   struct Node
+   {
+      /**
+       * the offset of the left child
+       */
+      uint64_t left;
+      /**
+       * the offset of the right child
+       */
+      uint64_t right;
+      /**
+       * the offset of the stored key
+       */
+      uint64_t key;
+      /**
+       * the size of the stored key
+       */
+      uint32_t keyLength;
+      /**
+       * the height of the subtree rooted at this node
+       */
+      int32_t height;
+   };
+
+   /**
+    * the name of the mapped file
+    */
+   string path;
+   /**
+    * the descriptor of the mapped file
+    */
+   int fd;
+   /**
+    * the start of the mapping
+    */
+   char* base;
+   /**
+    * the size of the file and of the mapping
+    */
+   uint64_t capacity;
+   /**
+    * indicates whether the keys are ordered by naturalOrder(), in which
+    * case keys are compared with the stored keys in place
+    */
+   bool natural;
+   /**
+    * A trichotomous integer-value comparator function
+    */
+   std::function<int(const E&, const E&)> cmp;
+
+   /**
+    * Gives the header of the file
+    * @return the header
+    */
+   Header* header() const
+   {
+      return reinterpret_cast<Header*>(base);
+   }
+
+   /**
+    * Gives the node at an offset; the address is good only until the
+    * next allocation, which may move the mapping
+    * @param offset the offset of a node
+    * @return the node
+    */
+   Node* at(uint64_t offset) const
+   {
+      return reinterpret_cast<Node*>(base + offset);
+   }
+
+   /**
+    * Maps the open file
+    */
+   void map();
+
+   /**
+    * Grows the file and its mapping to hold at least a number of bytes
+    * @param needed the least size of the file
+    * @throws AVLTreeException when the file cannot be grown or mapped
+    */
+   void grow(uint64_t needed);
+
+   /**
+    * Allocates fresh space at the end of the file
+    * @param bytes the size of the allocation
+    * @return the offset of the allocated space
+    */
+   uint64_t allocate(uint64_t bytes);
+
+   /**
+    * Gives the size class of a key block
+    * @param length the size of a stored key
+    * @return the index of the free list of its blocks
+    */
+   static int sizeClass(uint64_t length);
+
+   /**
+    * Allocates a block for a stored key, from the free list of its size
+    * class when it is not empty
+    * @param length the size of the stored key
+    * @return the offset of the block
+    */
+   uint64_t allocateKey(uint64_t length);
+
+   /**
+    * Puts a key block on the free list of its size class
+    * @param key the offset of the block
+    * @param length the size of the key stored in it
+    */
+   void freeKey(uint64_t key, uint64_t length);
+
+   /**
+    * Replaces the key of a node, moving it to a block of another size
+    * class when it no longer fits
+    * @param node the offset of the node
+    * @param obj the new key
+    */
+   void setKey(uint64_t node, const E& obj);
+
+   /**
+    * Allocates a node holding a copy of a key, with no children
+    * @param obj the key
+    * @return the offset of the node
+    */
+   uint64_t createNode(const E& obj);
+
+   /**
+    * Frees a node and its key block
+    * @param node the offset of the node
+    */
+   void freeNode(uint64_t node);
+
+   /**
+    * Compares an element with the key of a node
+    * @param item an element
+    * @param node the offset of a node
+    * @return a negative integer when item precedes the key of the node; 0
+    * when they are equal; otherwise, a positive integer
+    */
+   int compareAt(const E& item, uint64_t node) const;
+
+   /**
+    * Reads the key of a node
+    * @param node the offset of a node
+    * @return the key of the node
+    */
+   E keyAt(uint64_t node) const;
+
+   /**
+    * Gives the height of a subtree
+    * @param node the offset of the root of the subtree
+    * @return its height; -1 for an empty subtree
+    */
+   int heightOf(uint64_t node) const;
+
+   /**
+    * Recomputes the height of a node from those of its children
+    * @param node the offset of a node
+    */
+   void update(uint64_t node);
+
+   /**
+    * Rotates a subtree to the left
+    * @param node the offset of the root of the subtree
+    * @return the offset of the new root
+    */
+   uint64_t rotateLeft(uint64_t node);
+
+   /**
+    * Rotates a subtree to the right
+    * @param node the offset of the root of the subtree
+    * @return the offset of the new root
+    */
+   uint64_t rotateRight(uint64_t node);
+
+   /**
+    * Restores the balance of a subtree whose children are balanced
+    * @param node the offset of the root of the subtree
+    * @return the offset of the new root
+    */
+   uint64_t rebalance(uint64_t node);
+
+   /**
+    * Inserts a key into a subtree
+    * @param node the offset of the root of the subtree
+    * @param obj the key
+    * @return the offset of the new root
+    */
+   uint64_t insert(uint64_t node, const E& obj);
+
+   /**
+    * Deletes a key from a subtree
+    * @param node the offset of the root of the subtree
+    * @param item the key
+    * @return the offset of the new root
+    */
+   uint64_t remove(uint64_t node, const E& item);
+
+   /**
+    * Unlinks the leftmost node of a subtree
+    * @param node the offset of the root of the subtree
+    * @param detached receives the offset of the unlinked node
+    * @return the offset of the new root
+    */
+   uint64_t detachMin(uint64_t node, uint64_t& detached);
+public:
+   /**
+    * Opens a tree file, or creates an empty one, ordered by the < operator
+    * @param filename the name of the file
+    * @throws AVLTreeException when the file cannot be opened or mapped, or
+    * holds something other than a tree of this element type
+    */
+   MappedAVLTree(const string& filename);
+
+   /**
+    * Opens a tree file, or creates an empty one, ordered by the specified
+    * comparator
+    * @param filename the name of the file
+    * @param fn - an integer-value binary comparator function; the one the
+    * file was built with
+    * @throws AVLTreeException when the file cannot be opened or mapped, or
+    * holds something other than a tree of this element type
+    */
+   MappedAVLTree(const string& filename, std::function<int(const E&, const E&)> fn);
+
+   MappedAVLTree(const MappedAVLTree<E>& other) = delete;
+
+   MappedAVLTree<E>& operator=(const MappedAVLTree<E>& other) = delete;
+
+   /**
+    * destructor - unmaps and closes the file; writes not yet flushed
+    * reach it when the operating system writes back the pages
+    */
+   ~MappedAVLTree();
+
+   /**
+    * Determine whether the tree is empty.
+    * @return true if the tree is empty; otherwise, false
+    */
+   bool isEmpty() const;
+
+   /**
+    * Inserts an item into the tree; an item with the same key as one
+    * already in the tree replaces it, as in AVLTree
+    * @param obj the value to be inserted.
+    */
+   void insert(const E& obj);
+
+   /**
+    * Determine whether an item is in the tree.
+    * @param item item with a specified search key.
+    * @return true on success; false on failure.
+    */
+   bool inTree(const E& item) const;
+
+   /**
+    * Delete an item from the tree.
+    * @param item item with a specified search key.
+    */
+   void remove(const E& item);
+
+   /**
+    * returns a copy of the specified item in the tree
+    * @param key item with a specified search key.
+    * @return the item with the specified key
+    * @throws AVLTreeException when the item is not in the tree
+    */
+   E retrieve(const E& key) const;
+
+   /**
+    * This function traverses the tree in in-order
+    * and calls the function Visit once for each node.
+    * @param func the function to apply to the data in each node
+    */
+   void traverse(FuncType func) const;
+
+   /**
+    * Traverses, in order, the items from one key through another
+    * @param lo the least key of the range
+    * @param hi the greatest key of the range
+    * @param func the function to apply to each item in the range
+    */
+   void traverseBetween(const E& lo, const E& hi, FuncType func) const;
+
+   /**
+    * Returns the number of items in the tree.
+    * @return the number of items in the tree.
+    */
+   int size() const;
+
+   /**
+    * Gives the height of this tree
+    * @return the height of this tree; -1 when it is empty
+    */
+   int height() const;
+
+   /**
+    * Gives the size of the file
+    * @return the bytes mapped from the file
+    */
+   uint64_t fileSize() const;
+
+   /**
+    * Writes every change made to the tree to the file and waits until it
+    * is on disk
+    * @throws AVLTreeException when the changes cannot be written
+    */
+   void sync();
+};
+
+//MAPPEDAVLTREE_H
+#endif
@@ -0,0 +1,84 @@
+/**
+ * Models a pool of fixed-size memory blocks.
+ * @author William Duncan, Cody Carter
+ * @see NodePool
+ * <pre>
+ * Date: 10/18/2023
+ * </pre>
+ */
+#ifndef NODEPOOL_CPP
+#define NODEPOOL_CPP
+
+#include <new>
+#include "NodePool.h"
+
+using namespace std;
+
+inline NodePool::NodePool(size_t bytes, size_t blocksPerChunk)
+{
+   blockSize = bytes < sizeof(void*) ? sizeof(void*) : bytes;
+   blockSize = (blockSize + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+   chunkBlocks = blocksPerChunk < 1 ? 1 : blocksPerChunk;
+   fresh = 0;
+   freeList = NULL;
+   live = 0;
+}
+
+inline NodePool::~NodePool()
+{
+   release();
+}
+
+inline void* NodePool::allocate()
+{
+   void* block;
+   if (freeList != NULL)
+   {
+      block = freeList;
+      freeList = *static_cast<void**>(freeList);
+   }
+   else
+   {
+      if (fresh == 0)
+      {
+         chunks.push_back(static_cast<char*>(::operator new(blockSize * chunkBlocks)));
+         fresh = chunkBlocks;
+      }
+      block = chunks.back() + (chunkBlocks - fresh) * blockSize;
+      fresh--;
+   }
+   live++;
+   return block;
+}
+
+inline void NodePool::deallocate(void* block)
+{
+   *static_cast<void**>(block) = freeList;
+   freeList = block;
+   live--;
+}
+
+inline void NodePool::release()
+{
+   for (char* chunk : chunks)
+      ::operator delete(chunk);
+   chunks.clear();
+   fresh = 0;
+   freeList = NULL;
+   live = 0;
+}
+
+inline size_t NodePool::blocksPerChunk() const
+{
+   return chunkBlocks;
+}
+
+inline size_t NodePool::slack(size_t objectSize) const
+{
+   size_t reserved = chunks.size() * blockSize * chunkBlocks;
+   return reserved - live * objectSize
+      + chunks.size() * allocatorOverhead(blockSize * chunkBlocks);
+}
+
+//NODEPOOL_CPP
+#endif
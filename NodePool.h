@@ -0,0 +1,118 @@
+/**
+ * Models a pool of fixed-size memory blocks
+ * @author William Duncan, Cody Carter
+ * <pre>
+ * File: NodePool.h
+ * Date: 10/18/2023
+ * </pre>
+ */
+
+#include <cstddef>
+#include <vector>
+
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+using namespace std;
+
+/**
+ * Estimates the bytes a general-purpose heap allocator adds to a request
+ * of the specified size: an 8-byte header, 16-byte alignment and a
+ * 32-byte minimum block.
+ * @param bytes the number of bytes requested
+ * @return the allocator overhead for this request
+ */
+inline size_t allocatorOverhead(size_t bytes)
+{
+   if (bytes == 0)
+      return 0;
+   size_t block = (bytes + 8 + 15) & ~(size_t)15;
+   if (block < 32)
+      block = 32;
+   return block - bytes;
+}
+
+/**
+ * Hands out fixed-size blocks carved from large chunks, so that the nodes
+ * of a tree cost one allocation per chunk rather than one per node, and
+ * all of them can be returned to the system at once.
+ */
+class NodePool
+{
+private:
+   /**
+    * the size of each block in bytes
+    */
+   size_t blockSize;
+   /**
+    * the number of blocks carved from each chunk
+    */
+   size_t chunkBlocks;
+   /**
+    * the chunks allocated by this pool
+    */
+   vector<char*> chunks;
+   /**
+    * the number of blocks not yet carved from the newest chunk
+    */
+   size_t fresh;
+   /**
+    * the most recently freed block; each free block holds a pointer to
+    * the next one
+    */
+   void* freeList;
+   /**
+    * the number of blocks in use
+    */
+   size_t live;
+public:
+   /**
+    * Constructs an empty pool
+    * @param bytes the size of each block
+    * @param blocksPerChunk the number of blocks in each chunk
+    */
+   NodePool(size_t bytes, size_t blocksPerChunk);
+
+   NodePool(const NodePool& other) = delete;
+   NodePool& operator=(const NodePool& other) = delete;
+
+   /**
+    * destructor - returns every chunk to the system
+    */
+   ~NodePool();
+
+   /**
+    * Gives out an unused block
+    * @return a pointer to a block of at least the pool's block size
+    */
+   void* allocate();
+
+   /**
+    * Takes back a block given out by this pool
+    * @param block the block to be reused
+    */
+   void deallocate(void* block);
+
+   /**
+    * Returns every chunk to the system in O(chunks), invalidating all
+    * blocks given out by this pool
+    */
+   void release();
+
+   /**
+    * Gives the number of blocks in each chunk
+    * @return the number of blocks carved from each chunk
+    */
+   size_t blocksPerChunk() const;
+
+   /**
+    * Gives the bytes reserved by this pool that do not hold a live block:
+    * free and uncarved blocks, alignment padding and chunk headers
+    * @param objectSize the size of the objects stored in the blocks
+    * @return the bytes of this pool that are not in use
+    */
+   size_t slack(size_t objectSize) const;
+};
+
+//NODEPOOL_H
+#endif
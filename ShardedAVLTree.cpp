@@ -0,0 +1,180 @@
+/**
+ * Models an ordered set partitioned by key range over independent AVL trees.
+ * @param <E> data type of the set
+ * @author William Duncan, Cody Carter
+ * @see ShardedAVLTree
+ * <pre>
+ * Date: 10/18/2023
+ * </pre>
+ */
+#ifndef SHARDEDAVLTREE_CPP
+#define SHARDEDAVLTREE_CPP
+
+#include <mutex>
+#include "ShardedAVLTree.h"
+#include "AVLTree.cpp"
+
+using namespace std;
+
+template <typename E>
+ShardedAVLTree<E>::ShardedAVLTree(int shardCount)
+   : ShardedAVLTree(shardCount, [](const E& a, const E& b) -> int{return a < b? -1 : (b < a? 1 : 0);})
+{
+}
+
+template <typename E>
+ShardedAVLTree<E>::ShardedAVLTree(int shardCount, std::function<int(const E&, const E&)> fn, const vector<E>& initialSplits)
+{
+   if (shardCount < 1)
+      throw AVLTreeException("AVL Tree Exception: a sharded tree needs at least one shard");
+   cmp = fn;
+   keyCount = 0;
+   settled = 0;
+   growth = 0;
+   for (int i = 0; i < shardCount; i++)
+      shards.push_back(unique_ptr<Shard>(new Shard(fn)));
+   for (size_t i = 0; i < initialSplits.size() && (int)i < shardCount - 1; i++)
+      splits.push_back(initialSplits[i]);
+}
+
+template <typename E>
+bool ShardedAVLTree<E>::isEmpty() const
+{
+   return keyCount == 0;
+}
+
+template <typename E>
+void ShardedAVLTree<E>::insert(const E& obj)
+{
+   bool imbalanced;
+   {
+      shared_lock<shared_mutex> routing(layout);
+      Shard& shard = *shards[route(obj)];
+      unique_lock<shared_mutex> guard(shard.lock);
+      int before = shard.tree.size();
+      shard.tree.insert(obj);
+      int after = shard.tree.size();
+      keyCount += after - before;
+      growth += after - before;
+      imbalanced = overloaded(after);
+   }
+   if (imbalanced)
+      rebalance();
+}
+
+template <typename E>
+bool ShardedAVLTree<E>::inTree(const E& item) const
+{
+   shared_lock<shared_mutex> routing(layout);
+   Shard& shard = *shards[route(item)];
+   shared_lock<shared_mutex> guard(shard.lock);
+   return shard.tree.inTree(item);
+}
+
+template <typename E>
+void ShardedAVLTree<E>::remove(const E& item)
+{
+   shared_lock<shared_mutex> routing(layout);
+   Shard& shard = *shards[route(item)];
+   unique_lock<shared_mutex> guard(shard.lock);
+   int before = shard.tree.size();
+   shard.tree.remove(item);
+   keyCount += shard.tree.size() - before;
+}
+
+template <typename E>
+void ShardedAVLTree<E>::traverse(FuncType func) const
+{
+   shared_lock<shared_mutex> routing(layout);
+   for (size_t i = 0; i < shards.size(); i++)
+   {
+      shared_lock<shared_mutex> guard(shards[i]->lock);
+      shards[i]->tree.traverse(func);
+   }
+}
+
+template <typename E>
+int ShardedAVLTree<E>::size() const
+{
+   return keyCount;
+}
+
+template <typename E>
+vector<int> ShardedAVLTree<E>::shardSizes() const
+{
+   shared_lock<shared_mutex> routing(layout);
+   vector<int> sizes;
+   for (size_t i = 0; i < shards.size(); i++)
+   {
+      shared_lock<shared_mutex> guard(shards[i]->lock);
+      sizes.push_back(shards[i]->tree.size());
+   }
+   return sizes;
+}
+
+template <typename E>
+void ShardedAVLTree<E>::rebalance()
+{
+   unique_lock<shared_mutex> exclusive(layout);
+   int total = keyCount;
+   /* another writer may have rebalanced while this one waited */
+   bool needed = false;
+   for (size_t i = 0; i < shards.size() && !needed; i++)
+      needed = overloaded(shards[i]->tree.size());
+   if (!needed)
+      return;
+   vector<E> keys;
+   keys.reserve(total);
+   for (size_t i = 0; i < shards.size(); i++)
+   {
+      shards[i]->tree.traverse([&keys](const E& key) { keys.push_back(key); });
+      shards[i]->tree.clear();
+   }
+   settled = keys.size();
+   growth = 0;
+   int count = shards.size();
+   splits.clear();
+   for (int i = 1; i < count; i++)
+      splits.push_back(keys[(size_t)keys.size() * i / count]);
+   /* each shard receives a sorted run, which finger search inserts in
+      a few comparisons per key */
+   size_t next = 0;
+   for (int i = 0; i < count; i++)
+   {
+      size_t last = (size_t)keys.size() * (i + 1) / count;
+      for (; next < last; next++)
+         shards[i]->tree.insert(keys[next]);
+   }
+}
+
+/* Private functions */
+
+template <typename E>
+int ShardedAVLTree<E>::route(const E& key) const
+{
+   int lo = 0;
+   int hi = splits.size();
+   while (lo < hi)
+   {
+      int mid = (lo + hi) / 2;
+      if (cmp(splits[mid], key) <= 0)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
+template <typename E>
+bool ShardedAVLTree<E>::overloaded(int size) const
+{
+   int fair = keyCount / (int)shards.size();
+   /* a sorted stream overloads the last shard again soon after every
+      rebalance; waiting for the set to grow by half since the last one
+      keeps the cost of recomputing at a constant per insert */
+   return shards.size() > 1 && size >= REBALANCE_MINIMUM && size > 2 * fair
+      && growth >= settled / 2;
+}
+
+//SHARDEDAVLTREE_CPP
+#endif
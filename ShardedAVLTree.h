@@ -0,0 +1,183 @@
+/**
+ * Models an ordered set partitioned by key range over independent AVL trees
+ * @author William Duncan, Cody Carter
+ * <pre>
+ * File: ShardedAVLTree.h
+ * Date: 10/18/2023
+ * </pre>
+ */
+
+#include <functional>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <shared_mutex>
+#include "AVLTree.h"
+
+#ifndef SHARDEDAVLTREE_H
+#define SHARDEDAVLTREE_H
+
+using namespace std;
+
+/**
+ * Describes an ordered set, safe for concurrent use, whose key space is
+ * partitioned by split points into ranges, each kept in its own AVL tree
+ * with its own lock and node pool, so writers to different ranges do not
+ * serialize. Shard i holds the keys from split point i - 1 up to, but not
+ * including, split point i. When a shard grows to twice its fair share,
+ * and at least half as many keys have been inserted as the set held when
+ * the split points were last recomputed, the split points are recomputed
+ * from the keys so that every shard holds an equal part of them.
+ * @param <E> the data type
+ * @see AVLTree
+ */
+template <typename E>
+class ShardedAVLTree
+{
+private:
+   typedef std::function<void(const E&)> FuncType;
+   /**
+    * the fewest keys per shard before an imbalance triggers rebalancing
+    */
+   static const int REBALANCE_MINIMUM = 1024;
+
+   /**
+    * A key range: its tree and the lock guarding it, on its own cache lines
+    */
+   struct alignas(64) Shard
+   {
+      /**
+       * guards the tree; held shared by readers and exclusively by writers
+       */
+      std::shared_mutex lock;
+      /**
+       * the keys of this range
+       */
+      AVLTree<E> tree;
+
+      Shard(std::function<int(const E&, const E&)> fn) : tree(fn)
+      {
+         tree.usePool();
+      }
+   };
+
+   /**
+    * the shards in key order
+    */
+   vector<unique_ptr<Shard>> shards;
+   /**
+    * the split points between consecutive shards; at most one fewer than
+    * the shards, the last shards being unused when there are fewer
+    */
+   vector<E> splits;
+   /**
+    * guards the split points; held shared by every operation and
+    * exclusively while the keys are redistributed
+    */
+   mutable std::shared_mutex layout;
+   /**
+    * the number of keys in all shards
+    */
+   std::atomic<int> keyCount;
+   /**
+    * the number of keys when the split points were last recomputed
+    */
+   int settled;
+   /**
+    * the keys inserted since the split points were last recomputed
+    */
+   std::atomic<int> growth;
+   /**
+    * A trichotomous integer-value comparator function
+    */
+   std::function<int(const E&, const E&)> cmp;
+
+   /**
+    * Gives the shard whose range spans a key; the caller holds the layout lock
+    * @param key the search key
+    * @return the index of the shard
+    */
+   int route(const E& key) const;
+
+   /**
+    * Determines whether a shard has outgrown its fair share of the keys
+    * @param size the number of keys in the shard
+    * @return true when the split points should be recomputed
+    */
+   bool overloaded(int size) const;
+public:
+   /**
+    * Constructs an empty set ordered by the < operator
+    * @param shardCount the number of shards
+    */
+   ShardedAVLTree(int shardCount);
+
+   /**
+    * Constructs an empty set ordered by the specified comparator
+    * @param shardCount the number of shards
+    * @param fn - an integer-value binary comparator function
+    * @param initialSplits split points to start from, in order; at most
+    * shardCount - 1 of them are used
+    * @throws AVLTreeException when shardCount is not positive
+    */
+   ShardedAVLTree(int shardCount, std::function<int(const E&, const E&)> fn, const vector<E>& initialSplits = vector<E>());
+
+   ShardedAVLTree(const ShardedAVLTree<E>& other) = delete;
+
+   ShardedAVLTree<E>& operator=(const ShardedAVLTree<E>& other) = delete;
+
+   /**
+    * Determine whether the set is empty.
+    * @return true if the set is empty; otherwise, false
+    */
+   bool isEmpty() const;
+
+   /**
+    * Inserts an item into the shard whose range spans it, recomputing the
+    * split points afterwards when the shard has outgrown its share
+    * @param obj the value to be inserted.
+    */
+   void insert(const E& obj);
+
+   /**
+    * Determine whether an item is in the set.
+    * @param item item with a specified search key.
+    * @return true on success; false on failure.
+    */
+   bool inTree(const E& item) const;
+
+   /**
+    * Delete an item from the set.
+    * @param item item with a specified search key.
+    */
+   void remove(const E& item);
+
+   /**
+    * Traverses the set in order, one shard after another; each shard is
+    * locked while it is traversed, so the traversal is not a snapshot of
+    * the whole set
+    * @param func the function to apply to each item
+    */
+   void traverse(FuncType func) const;
+
+   /**
+    * Returns the number of items in the set.
+    * @return the number of items in the set.
+    */
+   int size() const;
+
+   /**
+    * Gives the number of items in each shard
+    * @return the sizes of the shards in key order
+    */
+   vector<int> shardSizes() const;
+
+   /**
+    * Recomputes the split points so that the shards hold equal parts of
+    * the keys and moves the keys accordingly; blocks all other operations
+    */
+   void rebalance();
+};
+
+//SHARDEDAVLTREE_H
+#endif
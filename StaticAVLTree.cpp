@@ -0,0 +1,151 @@
+/**
+ * Models a read-only ordered set built at compile time.
+ * @param <E> data type of the tree
+ * @author William Duncan, Cody Carter
+ * @see StaticAVLTree
+ * <pre>
+ * Date: 10/19/2023
+ * </pre>
+ */
+#ifndef STATICAVLTREE_CPP
+#define STATICAVLTREE_CPP
+
+#include "StaticAVLTree.h"
+
+using namespace std;
+
+template <typename E, size_t N, typename Cmp>
+constexpr StaticAVLTree<E,N,Cmp>::StaticAVLTree(const array<E, N>& keys, Cmp fn)
+   : nodes(), count(0), cmp(fn)
+{
+   /* the sort is stable, so the last of each run of equal keys is the
+      one given last: the one insertion keeps */
+   array<E, N> sorted = keys;
+   sort(sorted);
+   for (size_t i = 0; i < N; i++)
+      if (i + 1 == N || cmp(sorted[i], sorted[i + 1]) != 0)
+         sorted[count++] = sorted[i];
+   size_t next = 0;
+   place(sorted, 1, next);
+}
+
+template <typename E, size_t N, typename Cmp>
+constexpr bool StaticAVLTree<E,N,Cmp>::isEmpty() const
+{
+   return count == 0;
+}
+
+template <typename E, size_t N, typename Cmp>
+constexpr bool StaticAVLTree<E,N,Cmp>::inTree(const E& item) const
+{
+   return find(item) != 0;
+}
+
+template <typename E, size_t N, typename Cmp>
+constexpr const E& StaticAVLTree<E,N,Cmp>::retrieve(const E& key) const
+{
+   if (isEmpty())
+      throw AVLTreeException("AVL Tree Exception: tree empty on retrieve()");
+   size_t k = find(key);
+   if (k == 0)
+      throw AVLTreeException("AVL Tree Exception: key not in tree call to retrieve()");
+   return nodes[k - 1];
+}
+
+template <typename E, size_t N, typename Cmp>
+void StaticAVLTree<E,N,Cmp>::traverse(FuncType func) const
+{
+   if (count == 0)
+      return;
+   /* start at the leftmost node; the successor of a node is the leftmost
+      node of its right subtree or, failing that, the parent of the
+      nearest ancestor that is a left child */
+   size_t k = 1;
+   while (2 * k <= count)
+      k = 2 * k;
+   while (k != 0)
+   {
+      func(nodes[k - 1]);
+      if (2 * k + 1 <= count)
+      {
+         k = 2 * k + 1;
+         while (2 * k <= count)
+            k = 2 * k;
+      }
+      else
+      {
+         while (k % 2 == 1)
+            k = k / 2;
+         k = k / 2;
+      }
+   }
+}
+
+template <typename E, size_t N, typename Cmp>
+constexpr int StaticAVLTree<E,N,Cmp>::size() const
+{
+   return count;
+}
+
+template <typename E, size_t N, typename Cmp>
+constexpr int StaticAVLTree<E,N,Cmp>::height() const
+{
+   int levels = 0;
+   for (size_t k = count; k != 0; k = k / 2)
+      levels++;
+   return levels - 1;
+}
+
+/* Private functions */
+
+template <typename E, size_t N, typename Cmp>
+constexpr void StaticAVLTree<E,N,Cmp>::sort(array<E, N>& keys) const
+{
+   array<E, N> merged{};
+   for (size_t width = 1; width < N; width = 2 * width)
+   {
+      for (size_t first = 0; first < N; first += 2 * width)
+      {
+         size_t mid = first + width < N ? first + width : N;
+         size_t last = mid + width < N ? mid + width : N;
+         size_t i = first;
+         size_t j = mid;
+         size_t k = first;
+         /* a key of the right run goes first only when it is smaller */
+         while (i < mid && j < last)
+            merged[k++] = cmp(keys[j], keys[i]) < 0 ? keys[j++] : keys[i++];
+         while (i < mid)
+            merged[k++] = keys[i++];
+         while (j < last)
+            merged[k++] = keys[j++];
+      }
+      keys = merged;
+   }
+}
+
+template <typename E, size_t N, typename Cmp>
+constexpr void StaticAVLTree<E,N,Cmp>::place(const array<E, N>& sorted, size_t k, size_t& next)
+{
+   if (k > count)
+      return;
+   place(sorted, 2 * k, next);
+   nodes[k - 1] = sorted[next++];
+   place(sorted, 2 * k + 1, next);
+}
+
+template <typename E, size_t N, typename Cmp>
+constexpr size_t StaticAVLTree<E,N,Cmp>::find(const E& item) const
+{
+   size_t k = 1;
+   while (k <= count)
+   {
+      int diff = cmp(item, nodes[k - 1]);
+      if (diff == 0)
+         return k;
+      k = diff < 0 ? 2 * k : 2 * k + 1;
+   }
+   return 0;
+}
+
+//STATICAVLTREE_CPP
+#endif
@@ -0,0 +1,152 @@
+/**
+ * Models a read-only ordered set built at compile time
+ * @author William Duncan, Cody Carter
+ * <pre>
+ * File: StaticAVLTree.h
+ * Date: 10/19/2023
+ * </pre>
+ */
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include "AVLTree.h"
+
+#ifndef STATICAVLTREE_H
+#define STATICAVLTREE_H
+
+using namespace std;
+
+/**
+ * The order of a static tree when none is specified: that of the <
+ * operator, trichotomous like naturalOrder() but usable in constant
+ * expressions
+ * @param <E> the data type
+ */
+template <typename E>
+struct StaticOrder
+{
+   constexpr int operator()(const E& a, const E& b) const
+   {
+      return a < b ? -1 : (a == b ? 0 : 1);
+   }
+};
+
+/**
+ * Describes a read-only set of keys known when the program is compiled.
+ * The constructor sorts the keys and, of keys that compare equal, keeps
+ * the one given last, as inserting them into an AVLTree in turn would.
+ * It lays them out in breadth-first order: the root
+ * first, then the children of node k at 2k and 2k + 1, counting from 1.
+ * That is a complete binary tree, so it meets the AVL balance condition,
+ * and it needs no child pointers. Declared constexpr, a tree is built by
+ * the compiler and placed in read-only memory, so it costs nothing at
+ * startup. The keys must be of a literal type, such as integers or
+ * string_view.
+ * @param <E> the data type
+ * @param <N> the number of keys the tree is built from
+ * @param <Cmp> a trichotomous comparator usable in constant expressions
+ * @see AVLTree
+ */
+template <typename E, size_t N, typename Cmp = StaticOrder<E>>
+class StaticAVLTree
+{
+private:
+   typedef std::function<void(const E&)> FuncType;
+
+   /**
+    * the keys in breadth-first order; node k is at index k - 1
+    */
+   array<E, N> nodes;
+   /**
+    * the number of distinct keys
+    */
+   size_t count;
+   /**
+    * the order of the keys
+    */
+   Cmp cmp;
+
+   /**
+    * Sorts keys by a bottom-up merge sort, which needs no recursion and
+    * leaves equal keys in the order they were given
+    * @param keys the keys to be sorted
+    */
+   constexpr void sort(array<E, N>& keys) const;
+
+   /**
+    * Places sorted keys in the subtree rooted at node k in order
+    * @param sorted the distinct keys in order
+    * @param k the node number of the root of the subtree
+    * @param next the index of the next key to be placed; advanced past
+    * the keys placed
+    */
+   constexpr void place(const array<E, N>& sorted, size_t k, size_t& next);
+
+   /**
+    * Gives the node number of the node holding a key
+    * @param item the search key
+    * @return its node number; 0 when the key is not in the tree
+    */
+   constexpr size_t find(const E& item) const;
+public:
+   /**
+    * Builds a tree of the specified keys
+    * @param keys the keys, in any order, possibly repeated
+    */
+   constexpr explicit StaticAVLTree(const array<E, N>& keys, Cmp fn = Cmp());
+
+   /**
+    * Determine whether the tree is empty.
+    * @return true if the tree is empty; otherwise, false
+    */
+   constexpr bool isEmpty() const;
+
+   /**
+    * Determine whether an item is in the tree.
+    * @param item item with a specified search key.
+    * @return true on success; false on failure.
+    */
+   constexpr bool inTree(const E& item) const;
+
+   /**
+    * returns the item with the given search key.
+    * @param key the key of the item to be retrieved
+    * @return the item with the specified key
+    * @throws AVLTreeException when no such element exists
+    */
+   constexpr const E& retrieve(const E& key) const;
+
+   /**
+    * This function traverses the tree in in-order
+    * and calls the function Visit once for each node.
+    * @param func the function to apply to the data in each node
+    */
+   void traverse(FuncType func) const;
+
+   /**
+    * Returns the number of items in the tree.
+    * @return the number of items in the tree.
+    */
+   constexpr int size() const;
+
+   /**
+    * Gives the height of this tree
+    * @return the height of this tree; -1 when it is empty
+    */
+   constexpr int height() const;
+};
+
+/**
+ * Builds a static tree of the specified keys, counting them
+ * @param keys the keys, each convertible to E
+ * @return a tree of the distinct keys
+ */
+template <typename E, typename... Keys>
+constexpr StaticAVLTree<E, sizeof...(Keys)> makeStaticTree(const Keys&... keys)
+{
+   return StaticAVLTree<E, sizeof...(Keys)>(array<E, sizeof...(Keys)>{{E(keys)...}});
+}
+
+//STATICAVLTREE_H
+#endif
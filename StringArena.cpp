@@ -0,0 +1,61 @@
+/**
+ * Models string keys kept back to back in an arena.
+ * @author William Duncan, Cody Carter
+ * @see StringArena
+ * <pre>
+ * Date: 10/18/2023
+ * </pre>
+ */
+#ifndef STRINGARENA_CPP
+#define STRINGARENA_CPP
+
+#include "StringArena.h"
+
+using namespace std;
+
+inline StringArena::StringArena(size_t bytesPerChunk)
+   : chunkSize(bytesPerChunk), filled(bytesPerChunk), used(0), reserved(0)
+{
+}
+
+inline ArenaString StringArena::intern(const string& text)
+{
+   size_t length = text.size();
+   char* place;
+   if (length > chunkSize)
+   {
+      /* an oversized key goes in a chunk of its own, ahead of the
+         chunk being filled */
+      unique_ptr<char[]> own(new char[length]);
+      place = own.get();
+      chunks.insert(chunks.end() - (chunks.empty() ? 0 : 1), std::move(own));
+      reserved += length;
+   }
+   else
+   {
+      if (filled + length > chunkSize)
+      {
+         chunks.push_back(unique_ptr<char[]>(new char[chunkSize]));
+         reserved += chunkSize;
+         filled = 0;
+      }
+      place = chunks.back().get() + filled;
+      filled += length;
+   }
+   memcpy(place, text.data(), length);
+   used += length;
+   return ArenaString{place, length};
+}
+
+inline size_t StringArena::bytesUsed() const
+{
+   return used;
+}
+
+inline size_t StringArena::bytesReserved() const
+{
+   return reserved;
+}
+
+//STRINGARENA_CPP
+#endif
@@ -0,0 +1,163 @@
+/**
+ * Models string keys kept back to back in an arena
+ * @author William Duncan, Cody Carter
+ * <pre>
+ * File: StringArena.h
+ * Date: 10/18/2023
+ * </pre>
+ */
+
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef STRINGARENA_H
+#define STRINGARENA_H
+
+using namespace std;
+
+/**
+ * A string key whose characters live elsewhere, in a StringArena for the
+ * keys of a tree or in the caller's string for a search key. A node
+ * holding one keeps only its address and length, and the keys of a tree
+ * lie next to one another in the arena rather than in a heap block each.
+ * Keys compare by their characters, as strings do.
+ * @see StringArena
+ */
+struct ArenaString
+{
+   /**
+    * the first character of the key
+    */
+   const char* chars;
+   /**
+    * the number of characters in the key
+    */
+   size_t length;
+
+   /**
+    * Gives a key over the characters of a string, for searching; it is
+    * good only as long as the string is unchanged
+    * @param text a string
+    * @return a key over its characters
+    */
+   static ArenaString of(const string& text)
+   {
+      return ArenaString{text.data(), text.size()};
+   }
+
+   /**
+    * Gives the characters of the key
+    * @return a view of the characters
+    */
+   string_view view() const
+   {
+      return string_view(chars, length);
+   }
+};
+
+/**
+ * Compares two arena strings by their characters
+ * @param a an arena string
+ * @param b another arena string
+ * @return a negative integer when a precedes b; 0 when they are equal;
+ * otherwise, a positive integer
+ */
+inline int naturalOrder(const ArenaString& a, const ArenaString& b)
+{
+   size_t shorter = a.length < b.length ? a.length : b.length;
+   int diff = memcmp(a.chars, b.chars, shorter);
+   if (diff != 0)
+      return diff;
+   return (a.length > b.length) - (a.length < b.length);
+}
+
+inline bool operator<(const ArenaString& a, const ArenaString& b)
+{
+   return naturalOrder(a, b) < 0;
+}
+
+inline bool operator==(const ArenaString& a, const ArenaString& b)
+{
+   return a.length == b.length && memcmp(a.chars, b.chars, a.length) == 0;
+}
+
+inline ostream& operator<<(ostream& os, const ArenaString& key)
+{
+   return os << key.view();
+}
+
+/**
+ * Gives the hash of an arena string: that of its characters
+ * @param item an arena string
+ * @return the hash of the characters
+ */
+inline size_t keyHash(const ArenaString& item)
+{
+   return std::hash<string_view>()(item.view());
+}
+
+/**
+ * Keeps the characters of string keys back to back in large chunks, so
+ * that a key costs its length and no allocation of its own. Chunks are
+ * never moved, so interned keys stay valid as long as the arena lives;
+ * nor are they reclaimed key by key: the characters of a key removed from
+ * its tree stay in the arena until the arena is destroyed.
+ */
+class StringArena
+{
+private:
+   /**
+    * the chunks, the last one being filled
+    */
+   vector<unique_ptr<char[]>> chunks;
+   /**
+    * the size of a chunk
+    */
+   size_t chunkSize;
+   /**
+    * the characters used in the last chunk
+    */
+   size_t filled;
+   /**
+    * the characters interned
+    */
+   size_t used;
+   /**
+    * the bytes allocated for chunks
+    */
+   size_t reserved;
+public:
+   /**
+    * Constructs an empty arena
+    * @param bytesPerChunk the size of each chunk; longer keys get a chunk
+    * of their own
+    */
+   StringArena(size_t bytesPerChunk = 1 << 16);
+
+   /**
+    * Copies the characters of a string into the arena
+    * @param text a string
+    * @return a key over the copied characters
+    */
+   ArenaString intern(const string& text);
+
+   /**
+    * Gives the number of characters interned
+    * @return the bytes taken by interned keys
+    */
+   size_t bytesUsed() const;
+
+   /**
+    * Gives the memory allocated for the arena
+    * @return the bytes of all chunks
+    */
+   size_t bytesReserved() const;
+};
+
+//STRINGARENA_H
+#endif